@@ -0,0 +1,994 @@
+/*
+ * Copyright (C) 2007 Sasa Coh <sasacoh@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * This code is based on pjsip from Benny Prijono <benny@prijono.org>
+ *
+ */
+
+/*
+ * Mix-minus conference bus.
+ *
+ * In full mesh mode every call is connected with every other call in the
+ * conference bridge, which gives N*(N-1) connections and N*(N-1) frame
+ * additions per clock tick. In mix-minus mode each call gets one member
+ * port on the bus. Member ports are connected both ways with the call:
+ *  - put_frame() receives the call's audio,
+ *  - get_frame() returns sum of all members minus call's own audio.
+ * The sum is computed once per clock tick, so mixing cost is linear.
+ *
+ * Conference bridge first reads all ports (get_frame) and then writes
+ * all ports (put_frame) in each tick, so frames received in tick T are
+ * mixed at the first get_frame of tick T+1.
+ *
+ * Each room has its own bus and mutex, so rooms are mixed independently.
+ * Rooms and members are created and destroyed under module mutex, which
+ * is taken by every API function, hook and timer callback. Module mutex
+ * is taken before room mutex and is never held by the media thread.
+ * Room 0 is the default room used by dll_makeConference and auto
+ * conference, other rooms are created with dll_createConference.
+ *
+ * Each member tracks smoothed average amplitude of received audio and
+ * a simple energy VAD. The loudest talking member is the active speaker,
+ * changes are reported with onActiveSpeakerCallback from the pjsip timer
+ * heap, not from the media thread. When the room limits number of
+ * speakers, only the loudest talking members are summed, the others
+ * only listen.
+ */
+
+#include "pjsipDll_Conference.h"
+#include <pjsua-lib/pjsua.h>
+
+#if defined(__AVX2__)
+#	include <immintrin.h>
+#	define CONF_MIX_AVX2		1
+#elif defined(_M_X64) || defined(__x86_64__) || defined(__SSE2__)
+#	include <emmintrin.h>
+#	define CONF_MIX_SSE2		1
+#elif defined(_MSC_VER) && defined(_M_IX86)
+	// SSE2 intrinsics are available, CPU support is checked in conf_init()
+#	include <windows.h>
+#	include <emmintrin.h>
+#	define CONF_MIX_SSE2		1
+#	define CONF_MIX_SSE2_CHECK	1
+#endif
+
+#define THIS_FILE	"pjsipDll_Conference.cpp"
+#define SIGNATURE	PJMEDIA_PORT_SIGNATURE('S', 'C', 'M', 'M')
+#define CONF_MAX_MEMBERS	PJSUA_MAX_CALLS
+#define CONF_MAX_ROOMS		(PJSUA_MAX_CALLS+1)
+#define CONF_DEFAULT_ROOM	0
+#define CONF_VAD_THRESHOLD	200	/* average amplitude of speech	    */
+#define CONF_VAD_HANGOVER	25	/* ticks member stays active	    */
+#define CONF_SPEAKER_HOLD	10	/* ticks before speaker changes	    */
+
+struct conf_room;
+
+/* Room member. Media port connected both ways with call's conference slot */
+struct conf_member
+{
+	pjmedia_port	    base;
+	pj_pool_t	   *pool;
+	conf_room	   *room;
+	pjsua_call_id	    call_id;
+	pjsua_conf_port_id  slot;
+	char		    name[32];
+	pj_bool_t	    has_rx;	/* frame received in current tick   */
+	pj_bool_t	    in_mix;	/* mixed frame is part of room mix  */
+	unsigned	    level;	/* smoothed average amplitude	    */
+	unsigned	    vad_hangover; /* ticks left until silence	    */
+	pj_int16_t	   *rx;		/* last frame received from call    */
+	pj_int16_t	   *mixed;	/* frame used in current room mix   */
+};
+
+/* Conference room with a single mixing bus */
+struct conf_room
+{
+	pj_pool_t	   *pool;
+	pj_mutex_t	   *mutex;
+	int		    id;
+	unsigned	    clock_rate;
+	unsigned	    channel_count;
+	unsigned	    samples_per_frame;
+	pj_bool_t	    dirty;	/* frames received since last mix   */
+	pj_int32_t	   *mix;	/* sum of all mixed frames	    */
+	unsigned	    mix_cnt;	/* number of frames in mix	    */
+	unsigned	    member_cnt;
+	conf_member	   *members[CONF_MAX_MEMBERS];
+	unsigned	    max_speakers; /* 0 mixes all members	    */
+	conf_member	   *speaker;	/* current active speaker	    */
+	conf_member	   *candidate;	/* louder member waiting for floor  */
+	unsigned	    candidate_ticks;
+	int		    speaker_call; /* speaker to be reported	    */
+	int		    reported_call; /* speaker reported to app	    */
+	pj_bool_t	    speaker_pending;
+};
+
+static struct conf_data
+{
+	int		    mode;
+	pj_bool_t	    simd;
+	pj_pool_t	   *pool;
+	pj_mutex_t	   *mutex;
+	conf_room	   *rooms[CONF_MAX_ROOMS];
+	conf_member	   *call_member[PJSUA_MAX_CALLS];
+	/* outside of rooms, callback may run after its room is freed */
+	pj_timer_entry	    speaker_timer[CONF_MAX_ROOMS];
+	/* called after call is connected to new source, without mutex */
+	void		  (*on_call_source)(int callId);
+} conf;
+
+static fptr_activespeaker* cb_activespeaker = 0;
+
+
+//////////////////////////////////////////////////////////////////////////
+// Mixing kernels
+
+PJ_INLINE(pj_int16_t) clip16(pj_int32_t value)
+{
+	if (value > 32767) return 32767;
+	if (value < -32768) return -32768;
+	return (pj_int16_t)value;
+}
+
+/* acc[i] += src[i] */
+static void mix_add(pj_int32_t *acc, const pj_int16_t *src, unsigned count)
+{
+	unsigned i = 0;
+
+#if defined(CONF_MIX_AVX2)
+	for (; i+16 <= count; i+=16) {
+		__m256i s0 = _mm256_cvtepi16_epi32(_mm_loadu_si128((const __m128i*)(src+i)));
+		__m256i s1 = _mm256_cvtepi16_epi32(_mm_loadu_si128((const __m128i*)(src+i+8)));
+		__m256i a0 = _mm256_loadu_si256((const __m256i*)(acc+i));
+		__m256i a1 = _mm256_loadu_si256((const __m256i*)(acc+i+8));
+		_mm256_storeu_si256((__m256i*)(acc+i), _mm256_add_epi32(a0, s0));
+		_mm256_storeu_si256((__m256i*)(acc+i+8), _mm256_add_epi32(a1, s1));
+	}
+#elif defined(CONF_MIX_SSE2)
+	if (conf.simd) {
+		for (; i+8 <= count; i+=8) {
+			__m128i s = _mm_loadu_si128((const __m128i*)(src+i));
+			// sign extend 16 -> 32 bits
+			__m128i lo = _mm_srai_epi32(_mm_unpacklo_epi16(s, s), 16);
+			__m128i hi = _mm_srai_epi32(_mm_unpackhi_epi16(s, s), 16);
+			__m128i a0 = _mm_loadu_si128((const __m128i*)(acc+i));
+			__m128i a1 = _mm_loadu_si128((const __m128i*)(acc+i+4));
+			_mm_storeu_si128((__m128i*)(acc+i), _mm_add_epi32(a0, lo));
+			_mm_storeu_si128((__m128i*)(acc+i+4), _mm_add_epi32(a1, hi));
+		}
+	}
+#endif
+
+	for (; i<count; ++i)
+		acc[i] += src[i];
+}
+
+/* dst[i] = saturate16(acc[i] - self[i]), self may be NULL */
+static void mix_minus(pj_int16_t *dst, const pj_int32_t *acc,
+		      const pj_int16_t *self, unsigned count)
+{
+	unsigned i = 0;
+
+#if defined(CONF_MIX_AVX2)
+	for (; i+16 <= count; i+=16) {
+		__m256i a0 = _mm256_loadu_si256((const __m256i*)(acc+i));
+		__m256i a1 = _mm256_loadu_si256((const __m256i*)(acc+i+8));
+		__m256i r;
+		if (self) {
+			a0 = _mm256_sub_epi32(a0, _mm256_cvtepi16_epi32(_mm_loadu_si128((const __m128i*)(self+i))));
+			a1 = _mm256_sub_epi32(a1, _mm256_cvtepi16_epi32(_mm_loadu_si128((const __m128i*)(self+i+8))));
+		}
+		// pack works per 128-bit lane, restore sample order
+		r = _mm256_permute4x64_epi64(_mm256_packs_epi32(a0, a1), 0xD8);
+		_mm256_storeu_si256((__m256i*)(dst+i), r);
+	}
+#elif defined(CONF_MIX_SSE2)
+	if (conf.simd) {
+		for (; i+8 <= count; i+=8) {
+			__m128i a0 = _mm_loadu_si128((const __m128i*)(acc+i));
+			__m128i a1 = _mm_loadu_si128((const __m128i*)(acc+i+4));
+			if (self) {
+				__m128i s = _mm_loadu_si128((const __m128i*)(self+i));
+				a0 = _mm_sub_epi32(a0, _mm_srai_epi32(_mm_unpacklo_epi16(s, s), 16));
+				a1 = _mm_sub_epi32(a1, _mm_srai_epi32(_mm_unpackhi_epi16(s, s), 16));
+			}
+			_mm_storeu_si128((__m128i*)(dst+i), _mm_packs_epi32(a0, a1));
+		}
+	}
+#endif
+
+	for (; i<count; ++i)
+		dst[i] = clip16(acc[i] - (self ? self[i] : 0));
+}
+
+/* Average absolute amplitude of the frame */
+static unsigned frame_level(const pj_int16_t *buf, unsigned count)
+{
+	pj_uint32_t sum = 0;
+	unsigned i;
+
+	for (i=0; i<count; ++i)
+		sum += (buf[i] < 0) ? -buf[i] : buf[i];
+
+	return sum / count;
+}
+
+
+//////////////////////////////////////////////////////////////////////////
+// Room
+
+/* Deliver active speaker change to application, runs in pjsip worker */
+static void speaker_timer_cb(pj_timer_heap_t *timer_heap, struct pj_timer_entry *entry)
+{
+	int room_id = entry->id;
+	conf_room *room;
+	int call_id;
+
+	PJ_UNUSED_ARG(timer_heap);
+
+	if (conf.mutex == NULL)
+		return;
+
+	pj_mutex_lock(conf.mutex);
+
+	// room was destroyed while callback was waiting for the mutex
+	room = conf.rooms[room_id];
+	if (room == NULL) {
+		pj_mutex_unlock(conf.mutex);
+		return;
+	}
+
+	pj_mutex_lock(room->mutex);
+	room->speaker_pending = PJ_FALSE;
+	call_id = room->speaker_call;
+	pj_mutex_unlock(room->mutex);
+
+	if (call_id == room->reported_call) {
+		pj_mutex_unlock(conf.mutex);
+		return;
+	}
+	room->reported_call = call_id;
+
+	pj_mutex_unlock(conf.mutex);
+
+	if (cb_activespeaker != 0)
+		(*cb_activespeaker)(room_id, call_id);
+}
+
+/* Room mutex must be held */
+static void room_report_speaker(conf_room *room)
+{
+	pj_time_val delay = {0, 0};
+
+	room->speaker_call = room->speaker ? room->speaker->call_id : PJSUA_INVALID_ID;
+
+	if (room->speaker_pending || cb_activespeaker == 0)
+		return;
+
+	if (pjsip_endpt_schedule_timer(pjsua_get_pjsip_endpt(), &conf.speaker_timer[room->id],
+				       &delay) == PJ_SUCCESS)
+		room->speaker_pending = PJ_TRUE;
+}
+
+/* Find the loudest talking member. New speaker gets the floor after it
+ * stays the loudest for CONF_SPEAKER_HOLD ticks. Room mutex must be held
+ */
+static void room_update_speaker(conf_room *room)
+{
+	conf_member *loudest = NULL;
+	unsigned i;
+
+	for (i=0; i<room->member_cnt; ++i) {
+		conf_member *m = room->members[i];
+
+		if (m->vad_hangover == 0)
+			continue;
+		if (loudest == NULL || m->level > loudest->level)
+			loudest = m;
+	}
+
+	if (loudest == room->speaker) {
+		room->candidate = NULL;
+		return;
+	}
+
+	if (loudest != room->candidate) {
+		room->candidate = loudest;
+		room->candidate_ticks = 0;
+	}
+
+	// silence is reported without delay, VAD hangover already holds it
+	if (loudest && room->speaker && ++room->candidate_ticks < CONF_SPEAKER_HOLD)
+		return;
+
+	room->speaker = loudest;
+	room->candidate = NULL;
+	room_report_speaker(room);
+}
+
+/* Select members to be mixed. Without limit, every received frame is
+ * mixed, otherwise only frames of max_speakers loudest talking members.
+ * Room mutex must be held
+ */
+static void room_select(conf_room *room)
+{
+	conf_member *sel[CONF_MAX_MEMBERS];
+	unsigned sel_cnt = 0;
+	unsigned i, j;
+
+	for (i=0; i<room->member_cnt; ++i) {
+		conf_member *m = room->members[i];
+
+		m->in_mix = m->has_rx;
+		m->has_rx = PJ_FALSE;
+
+		if (!m->in_mix || room->max_speakers == 0)
+			continue;
+
+		if (m->vad_hangover == 0) {
+			m->in_mix = PJ_FALSE;
+			continue;
+		}
+
+		// keep sel ordered by level, rooms are small
+		for (j=sel_cnt; j>0 && sel[j-1]->level < m->level; --j)
+			sel[j] = sel[j-1];
+		sel[j] = m;
+		++sel_cnt;
+	}
+
+	for (i=room->max_speakers; i<sel_cnt; ++i)
+		sel[i]->in_mix = PJ_FALSE;
+}
+
+/* Sum all selected frames. Room mutex must be held */
+static void room_mix(conf_room *room)
+{
+	unsigned i;
+	unsigned count = room->samples_per_frame;
+
+	pj_bzero(room->mix, count * sizeof(pj_int32_t));
+	room->mix_cnt = 0;
+
+	room_update_speaker(room);
+	room_select(room);
+
+	for (i=0; i<room->member_cnt; ++i) {
+		conf_member *m = room->members[i];
+
+		if (!m->in_mix)
+			continue;
+
+		pj_memcpy(m->mixed, m->rx, count * sizeof(pj_int16_t));
+		mix_add(room->mix, m->mixed, count);
+		++room->mix_cnt;
+	}
+	room->dirty = PJ_FALSE;
+}
+
+/* Bridge reads audio for the call: sum of others */
+static pj_status_t member_get_frame(pjmedia_port *this_port, pjmedia_frame *frame)
+{
+	conf_member *m = (conf_member*) this_port;
+	conf_room *room = m->room;
+	unsigned count = room->samples_per_frame;
+
+	pj_mutex_lock(room->mutex);
+
+	if (room->dirty)
+		room_mix(room);
+
+	// nobody else is talking
+	if (room->mix_cnt == 0 || (room->mix_cnt == 1 && m->in_mix)) {
+		pj_mutex_unlock(room->mutex);
+		frame->type = PJMEDIA_FRAME_TYPE_NONE;
+		frame->size = 0;
+		return PJ_SUCCESS;
+	}
+
+	mix_minus((pj_int16_t*)frame->buf, room->mix, m->in_mix ? m->mixed : NULL, count);
+
+	pj_mutex_unlock(room->mutex);
+
+	frame->type = PJMEDIA_FRAME_TYPE_AUDIO;
+	frame->size = count * sizeof(pj_int16_t);
+
+	return PJ_SUCCESS;
+}
+
+/* Bridge writes audio received from the call */
+static pj_status_t member_put_frame(pjmedia_port *this_port, const pjmedia_frame *frame)
+{
+	conf_member *m = (conf_member*) this_port;
+	conf_room *room = m->room;
+	pj_size_t size = room->samples_per_frame * sizeof(pj_int16_t);
+	pj_bool_t has_audio;
+	unsigned level = 0;
+
+	has_audio = (frame->type == PJMEDIA_FRAME_TYPE_AUDIO && frame->size >= size);
+	if (has_audio)
+		level = frame_level((const pj_int16_t*)frame->buf, room->samples_per_frame);
+
+	pj_mutex_lock(room->mutex);
+
+	if (has_audio) {
+		pj_memcpy(m->rx, frame->buf, size);
+		m->has_rx = PJ_TRUE;
+	} else {
+		m->has_rx = PJ_FALSE;
+	}
+
+	// fast attack, slow decay
+	if (level > m->level)
+		m->level = (m->level + level) / 2;
+	else
+		m->level = (m->level * 7 + level) / 8;
+
+	if (m->level >= CONF_VAD_THRESHOLD)
+		m->vad_hangover = CONF_VAD_HANGOVER;
+	else if (m->vad_hangover > 0)
+		--m->vad_hangover;
+
+	room->dirty = PJ_TRUE;
+
+	pj_mutex_unlock(room->mutex);
+
+	return PJ_SUCCESS;
+}
+
+/* Module mutex must be held */
+static pj_status_t room_create(int id, conf_room **p_room)
+{
+	pjsua_conf_port_info master;
+	pj_pool_t *pool;
+	conf_room *room;
+	pj_status_t status;
+
+	// use bridge format, so the bridge doesn't need to resample members
+	status = pjsua_conf_get_port_info(0, &master);
+	if (status != PJ_SUCCESS)
+		return status;
+
+	pool = pjsua_pool_create("confroom", 1000, 1000);
+	room = PJ_POOL_ZALLOC_T(pool, conf_room);
+	room->pool = pool;
+	room->id = id;
+	room->speaker_call = PJSUA_INVALID_ID;
+	room->reported_call = PJSUA_INVALID_ID;
+	room->clock_rate = master.clock_rate;
+	room->channel_count = master.channel_count;
+	room->samples_per_frame = master.samples_per_frame;
+	room->mix = (pj_int32_t*) pj_pool_zalloc(pool, room->samples_per_frame * sizeof(pj_int32_t));
+
+	status = pj_mutex_create_simple(pool, "confroom", &room->mutex);
+	if (status != PJ_SUCCESS) {
+		pj_pool_release(pool);
+		return status;
+	}
+
+	conf.rooms[id] = room;
+	if (p_room)
+		*p_room = room;
+	return PJ_SUCCESS;
+}
+
+/* Connect member port and call both ways. Call slot is looked up by the
+ * caller before module mutex is taken, pjsua locks it.
+ */
+static void member_connect(conf_member *m, pjsua_conf_port_id call_slot)
+{
+	if (call_slot == PJSUA_INVALID_ID)
+		return;
+
+	pjsua_conf_connect(call_slot, m->slot);
+	pjsua_conf_connect(m->slot, call_slot);
+}
+
+/* Module mutex must be held */
+static pj_status_t member_add(conf_room *room, pjsua_call_id call_id,
+			      pjsua_conf_port_id call_slot)
+{
+	pj_pool_t *pool;
+	conf_member *m;
+	pj_str_t name;
+	pj_size_t size = room->samples_per_frame * sizeof(pj_int16_t);
+	pj_status_t status;
+
+	if (room->member_cnt >= CONF_MAX_MEMBERS)
+		return PJ_ETOOMANY;
+
+	pool = pjsua_pool_create("confm", 512, 512);
+	m = PJ_POOL_ZALLOC_T(pool, conf_member);
+	m->pool = pool;
+	m->room = room;
+	m->call_id = call_id;
+	m->rx = (pj_int16_t*) pj_pool_zalloc(pool, size);
+	m->mixed = (pj_int16_t*) pj_pool_zalloc(pool, size);
+
+	pj_ansi_snprintf(m->name, sizeof(m->name), "confm-%d", call_id);
+	name = pj_str(m->name);
+	pjmedia_port_info_init(&m->base.info, &name, SIGNATURE, room->clock_rate,
+			       room->channel_count, 16, room->samples_per_frame);
+	m->base.get_frame = &member_get_frame;
+	m->base.put_frame = &member_put_frame;
+
+	// bridge calls are made without room mutex, bridge holds its own
+	// mutex when calling member_get_frame/member_put_frame
+	status = pjsua_conf_add_port(pool, &m->base, &m->slot);
+	if (status != PJ_SUCCESS) {
+		pj_pool_release(pool);
+		return status;
+	}
+
+	pj_mutex_lock(room->mutex);
+	room->members[room->member_cnt++] = m;
+	pj_mutex_unlock(room->mutex);
+
+	conf.call_member[call_id] = m;
+
+	member_connect(m, call_slot);
+
+	PJ_LOG(4,(THIS_FILE, "Call %d joined conference %d (%d members)",
+		  call_id, room->id, room->member_cnt));
+
+	return PJ_SUCCESS;
+}
+
+/* Module mutex must be held */
+static void member_remove(conf_member *m)
+{
+	conf_room *room = m->room;
+	unsigned i;
+
+	pj_mutex_lock(room->mutex);
+	for (i=0; i<room->member_cnt; ++i) {
+		if (room->members[i] == m) {
+			room->members[i] = room->members[--room->member_cnt];
+			room->members[room->member_cnt] = NULL;
+			break;
+		}
+	}
+	if (room->candidate == m)
+		room->candidate = NULL;
+	if (room->speaker == m) {
+		room->speaker = NULL;
+		room_report_speaker(room);
+	}
+	room->dirty = PJ_TRUE;
+	pj_mutex_unlock(room->mutex);
+
+	conf.call_member[m->call_id] = NULL;
+
+	// after the port is removed from the bridge it is not accessed anymore
+	pjsua_conf_remove_port(m->slot);
+
+	PJ_LOG(4,(THIS_FILE, "Call %d left conference %d (%d members)",
+		  m->call_id, room->id, room->member_cnt));
+
+	pj_pool_release(m->pool);
+}
+
+/* Module mutex must be held. Members are removed first, so the media
+ * thread can't schedule speaker timer again once it is cancelled.
+ */
+static void room_destroy(conf_room *room)
+{
+	while (room->member_cnt > 0)
+		member_remove(room->members[room->member_cnt-1]);
+
+	conf.rooms[room->id] = NULL;
+
+	pjsip_endpt_cancel_timer(pjsua_get_pjsip_endpt(), &conf.speaker_timer[room->id]);
+
+	pj_mutex_destroy(room->mutex);
+	pj_pool_release(room->pool);
+}
+
+/* Module mutex must be held */
+static conf_room *room_find(int roomId)
+{
+	if (roomId < 0 || roomId >= CONF_MAX_ROOMS)
+		return NULL;
+	return conf.rooms[roomId];
+}
+
+/* Add call to room, call already in other room is moved. Module mutex
+ * must be held
+ */
+static pj_status_t room_join(conf_room *room, pjsua_call_id call_id,
+			     pjsua_conf_port_id call_slot)
+{
+	conf_member *m = conf.call_member[call_id];
+
+	if (m && m->room == room) {
+		member_connect(m, call_slot);
+		return PJ_SUCCESS;
+	}
+
+	if (m)
+		member_remove(m);
+
+	return member_add(room, call_id, call_slot);
+}
+
+/* Call left a room other than default room, connect it with the sound
+ * device again as on_call_media_state does. Must be called without
+ * module mutex, pjsua locks the call.
+ */
+static void call_restore_sound(pjsua_call_id call_id)
+{
+	pjsua_conf_port_id call_slot;
+
+	if (!pjsua_call_has_media(call_id))
+		return;
+
+	call_slot = pjsua_call_get_conf_port(call_id);
+	if (call_slot == PJSUA_INVALID_ID)
+		return;
+
+	pjsua_conf_connect(call_slot, 0);
+	pjsua_conf_connect(0, call_slot);
+
+	if (conf.on_call_source)
+		(*conf.on_call_source)(call_id);
+}
+
+
+//////////////////////////////////////////////////////////////////////////
+// Internal hooks
+
+int conf_init(void (*on_call_source)(int callId))
+{
+	pj_status_t status;
+	int i;
+
+	// conference mode may be set before dll_init
+	pj_bzero(conf.rooms, sizeof(conf.rooms));
+	pj_bzero(conf.call_member, sizeof(conf.call_member));
+	conf.on_call_source = on_call_source;
+
+	conf.pool = pjsua_pool_create("conf", 512, 512);
+	status = pj_mutex_create_simple(conf.pool, "conf", &conf.mutex);
+	if (status != PJ_SUCCESS) {
+		pj_pool_release(conf.pool);
+		conf.pool = NULL;
+		conf.mutex = NULL;
+		return status;
+	}
+
+	for (i=0; i<CONF_MAX_ROOMS; ++i)
+		pj_timer_entry_init(&conf.speaker_timer[i], i, NULL, &speaker_timer_cb);
+
+#if defined(CONF_MIX_SSE2_CHECK)
+	conf.simd = IsProcessorFeaturePresent(PF_XMMI64_INSTRUCTIONS_AVAILABLE) ? PJ_TRUE : PJ_FALSE;
+#elif defined(CONF_MIX_SSE2) || defined(CONF_MIX_AVX2)
+	conf.simd = PJ_TRUE;
+#endif
+
+	PJ_LOG(4,(THIS_FILE, "Conference mixing uses %s",
+#if defined(CONF_MIX_AVX2)
+		"AVX2"
+#else
+		conf.simd ? "SSE2" : "scalar code"
+#endif
+		));
+
+	return PJ_SUCCESS;
+}
+
+void conf_destroy(void)
+{
+	pj_mutex_t *mutex = conf.mutex;
+	unsigned i;
+
+	if (mutex == NULL)
+		return;
+
+	pj_mutex_lock(mutex);
+	for (i=0; i<PJ_ARRAY_SIZE(conf.rooms); ++i) {
+		if (conf.rooms[i])
+			room_destroy(conf.rooms[i]);
+	}
+	conf.mutex = NULL;
+	pj_mutex_unlock(mutex);
+
+	pj_mutex_destroy(mutex);
+	pj_pool_release(conf.pool);
+	conf.pool = NULL;
+}
+
+/* Put call to default conference. Returns 0 if call has to be conferenced
+ * in full mesh mode by the caller. Call that is already in a room stays
+ * there.
+ */
+int conf_join(int callId)
+{
+	pjsua_conf_port_id call_slot;
+	pj_status_t status;
+
+	if (conf.mode != CM_MIX_MINUS)
+		return 0;
+
+	if (callId < 0 || callId >= (int)PJ_ARRAY_SIZE(conf.call_member) || conf.mutex == NULL)
+		return -1;
+
+	if (!pjsua_call_has_media(callId))
+		return -1;
+
+	call_slot = pjsua_call_get_conf_port(callId);
+
+	pj_mutex_lock(conf.mutex);
+
+	if (conf.call_member[callId]) {
+		member_connect(conf.call_member[callId], call_slot);
+		pj_mutex_unlock(conf.mutex);
+		return 1;
+	}
+
+	if (conf.rooms[CONF_DEFAULT_ROOM] == NULL) {
+		status = room_create(CONF_DEFAULT_ROOM, NULL);
+		if (status != PJ_SUCCESS) {
+			pj_mutex_unlock(conf.mutex);
+			pjsua_perror(THIS_FILE, "Unable to create conference room", status);
+			return -1;
+		}
+	}
+
+	status = member_add(conf.rooms[CONF_DEFAULT_ROOM], callId, call_slot);
+	pj_mutex_unlock(conf.mutex);
+
+	if (status != PJ_SUCCESS) {
+		pjsua_perror(THIS_FILE, "Unable to add call to conference", status);
+		return -1;
+	}
+
+	if (conf.on_call_source)
+		(*conf.on_call_source)(callId);
+	return 1;
+}
+
+/* Call media has been (re)created, reconnect member port to new conf slot.
+ * Returns room id of the call or -1 if call is not in any room.
+ */
+int conf_on_call_media(int callId)
+{
+	pjsua_conf_port_id call_slot = PJSUA_INVALID_ID;
+	conf_member *m;
+	int room_id = -1;
+
+	if (callId < 0 || callId >= (int)PJ_ARRAY_SIZE(conf.call_member) || conf.mutex == NULL)
+		return -1;
+
+	if (pjsua_call_has_media(callId))
+		call_slot = pjsua_call_get_conf_port(callId);
+
+	pj_mutex_lock(conf.mutex);
+	m = conf.call_member[callId];
+	if (m) {
+		member_connect(m, call_slot);
+		room_id = m->room->id;
+	}
+	pj_mutex_unlock(conf.mutex);
+
+	return room_id;
+}
+
+void conf_on_call_disconnected(int callId)
+{
+	if (callId < 0 || callId >= (int)PJ_ARRAY_SIZE(conf.call_member) || conf.mutex == NULL)
+		return;
+
+	pj_mutex_lock(conf.mutex);
+	if (conf.call_member[callId])
+		member_remove(conf.call_member[callId]);
+	pj_mutex_unlock(conf.mutex);
+}
+
+
+//////////////////////////////////////////////////////////////////////////
+// Public API
+
+int onActiveSpeakerCallback(fptr_activespeaker cb)
+{
+	cb_activespeaker = cb;
+	return 1;
+}
+
+int dll_setConferenceMode(int mode)
+{
+	if (mode != CM_FULL_MESH && mode != CM_MIX_MINUS)
+		return PJ_EINVAL;
+
+	conf.mode = mode;
+	return PJ_SUCCESS;
+}
+
+int dll_getConferenceMode()
+{
+	return conf.mode;
+}
+
+int dll_createConference()
+{
+	int i;
+	pj_status_t status;
+
+	if (conf.mutex == NULL)
+		return -1;
+
+	pj_mutex_lock(conf.mutex);
+	for (i=CONF_DEFAULT_ROOM+1; i<CONF_MAX_ROOMS; ++i) {
+		if (conf.rooms[i] == NULL)
+			break;
+	}
+	if (i == CONF_MAX_ROOMS) {
+		pj_mutex_unlock(conf.mutex);
+		return -1;
+	}
+
+	status = room_create(i, NULL);
+	pj_mutex_unlock(conf.mutex);
+
+	if (status != PJ_SUCCESS) {
+		pjsua_perror(THIS_FILE, "Unable to create conference room", status);
+		return -1;
+	}
+	return i;
+}
+
+int dll_destroyConference(int roomId)
+{
+	conf_room *room;
+	pjsua_call_id calls[CONF_MAX_MEMBERS];
+	unsigned count = 0, i;
+
+	if (conf.mutex == NULL)
+		return PJ_EINVALIDOP;
+
+	pj_mutex_lock(conf.mutex);
+	room = room_find(roomId);
+	if (room == NULL) {
+		pj_mutex_unlock(conf.mutex);
+		return PJ_EINVAL;
+	}
+
+	// members of default room are connected to sound device already
+	if (roomId != CONF_DEFAULT_ROOM) {
+		for (i=0; i<room->member_cnt; ++i)
+			calls[count++] = room->members[i]->call_id;
+	}
+
+	room_destroy(room);
+	pj_mutex_unlock(conf.mutex);
+
+	for (i=0; i<count; ++i)
+		call_restore_sound(calls[i]);
+
+	return PJ_SUCCESS;
+}
+
+int dll_conferenceAdd(int roomId, int callId)
+{
+	conf_room *room;
+	pjsua_conf_port_id call_slot;
+	int prev_room = -1;
+	pj_status_t status;
+
+	if (callId < 0 || callId >= (int)PJ_ARRAY_SIZE(conf.call_member))
+		return PJ_EINVAL;
+
+	if (conf.mutex == NULL)
+		return PJ_EINVALIDOP;
+
+	if (!pjsua_call_has_media(callId))
+		return PJ_EINVALIDOP;
+
+	call_slot = pjsua_call_get_conf_port(callId);
+
+	pj_mutex_lock(conf.mutex);
+	room = room_find(roomId);
+	if (room == NULL) {
+		pj_mutex_unlock(conf.mutex);
+		return PJ_EINVAL;
+	}
+
+	if (conf.call_member[callId])
+		prev_room = conf.call_member[callId]->room->id;
+
+	status = room_join(room, callId, call_slot);
+	pj_mutex_unlock(conf.mutex);
+
+	if (status != PJ_SUCCESS) {
+		pjsua_perror(THIS_FILE, "Unable to add call to conference", status);
+		return status;
+	}
+
+	// room members only hear each other, default room uses sound device
+	if (roomId != CONF_DEFAULT_ROOM) {
+		pjsua_conf_disconnect(call_slot, 0);
+		pjsua_conf_disconnect(0, call_slot);
+	} else if (prev_room > CONF_DEFAULT_ROOM) {
+		call_restore_sound(callId);
+	}
+
+	if (conf.on_call_source)
+		(*conf.on_call_source)(callId);
+	return PJ_SUCCESS;
+}
+
+int dll_conferenceRemove(int roomId, int callId)
+{
+	conf_room *room;
+	conf_member *m;
+
+	if (callId < 0 || callId >= (int)PJ_ARRAY_SIZE(conf.call_member))
+		return PJ_EINVAL;
+
+	if (conf.mutex == NULL)
+		return PJ_EINVALIDOP;
+
+	pj_mutex_lock(conf.mutex);
+	room = room_find(roomId);
+	if (room == NULL) {
+		pj_mutex_unlock(conf.mutex);
+		return PJ_EINVAL;
+	}
+
+	m = conf.call_member[callId];
+	if (m == NULL || m->room != room) {
+		pj_mutex_unlock(conf.mutex);
+		return PJ_ENOTFOUND;
+	}
+
+	member_remove(m);
+	pj_mutex_unlock(conf.mutex);
+
+	if (roomId != CONF_DEFAULT_ROOM)
+		call_restore_sound(callId);
+
+	return PJ_SUCCESS;
+}
+
+int dll_setConferenceSpeakers(int roomId, int maxSpeakers)
+{
+	conf_room *room;
+	pj_status_t status = PJ_SUCCESS;
+
+	if (maxSpeakers < 0)
+		return PJ_EINVAL;
+
+	if (conf.mutex == NULL)
+		return PJ_EINVALIDOP;
+
+	pj_mutex_lock(conf.mutex);
+	room = room_find(roomId);
+
+	// default room is created on demand
+	if (room == NULL && roomId == CONF_DEFAULT_ROOM)
+		status = room_create(CONF_DEFAULT_ROOM, &room);
+
+	if (room) {
+		pj_mutex_lock(room->mutex);
+		room->max_speakers = maxSpeakers;
+		pj_mutex_unlock(room->mutex);
+	} else if (status == PJ_SUCCESS) {
+		status = PJ_EINVAL;
+	}
+	pj_mutex_unlock(conf.mutex);
+
+	return status;
+}
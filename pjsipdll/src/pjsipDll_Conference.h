@@ -0,0 +1,60 @@
+/*
+ * Copyright (C) 2007 Sasa Coh <sasacoh@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+// pjsipDll_Conference.h : Mix-minus conference bus and conference rooms
+//
+
+#ifdef LINUX
+	#define __stdcall
+	#define PJSIPDLL_DLL_API
+#else
+#ifdef PJSIPDLL_EXPORTS
+	#define PJSIPDLL_DLL_API __declspec(dllexport)
+#else
+	#define PJSIPDLL_DLL_API __declspec(dllimport)
+#endif
+#endif
+
+// Conference modes used by dll_makeConference and auto conference
+enum EConferenceMode
+{
+	CM_FULL_MESH,		// connect each call with every other call in conference bridge
+	CM_MIX_MINUS		// single mixing bus per conference, each call hears sum minus itself
+};
+
+// calback function definitions
+typedef int __stdcall fptr_activespeaker(int roomId, int callId);	// callId -1 when room is silent
+
+// Callback registration
+extern "C" PJSIPDLL_DLL_API int onActiveSpeakerCallback(fptr_activespeaker cb); // register active speaker notifier
+
+// Conference API
+extern "C" PJSIPDLL_DLL_API int dll_setConferenceMode(int mode);
+extern "C" PJSIPDLL_DLL_API int dll_getConferenceMode();
+extern "C" PJSIPDLL_DLL_API int dll_createConference();
+extern "C" PJSIPDLL_DLL_API int dll_destroyConference(int roomId);
+extern "C" PJSIPDLL_DLL_API int dll_conferenceAdd(int roomId, int callId);
+extern "C" PJSIPDLL_DLL_API int dll_conferenceRemove(int roomId, int callId);	// call is reconnected to sound device
+extern "C" PJSIPDLL_DLL_API int dll_setConferenceSpeakers(int roomId, int maxSpeakers);	// 0 mixes all members
+
+// Internal hooks called by pjsipDll.cpp
+int conf_init(void (*on_call_source)(int callId));
+void conf_destroy(void);
+int conf_join(int callId);
+int conf_on_call_media(int callId);
+void conf_on_call_disconnected(int callId);
@@ -0,0 +1,1080 @@
+/*
+ * Copyright (C) 2007 Sasa Coh <sasacoh@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * This code is based on pjsip from Benny Prijono <benny@prijono.org>
+ *
+ */
+
+/*
+ * DTMF digit collection.
+ *
+ * IVR menus usually need a whole string of digits ("enter your PIN
+ * followed by #"). Instead of one onDtmfDigitCallback per key press,
+ * digits are buffered natively and delivered with single
+ * onDigitsCollectedCallback when collection finishes.
+ *
+ * Each call has one collector and one timer entry. Each key press moves
+ * the deadline and reschedules the timer to it. When timer fires before
+ * the current deadline it is rescheduled for the remaining time. Timer
+ * that was already taken off the heap is left to its callback, which
+ * sees the latest state. Completion is always reported from the pjsip
+ * timer heap, so the application is never called from the media or
+ * ioqueue thread.
+ *
+ * In-band DTMF.
+ *
+ * Some trunks send DTMF only as audio tones. When in-band detection is
+ * enabled for the account, each call with active media gets a detector
+ * port, connected from the call's conference slot as a tap. Detector
+ * runs eight Goertzel filters over blocks of 12.75 msec. Filters are
+ * kept in arrays and updated together, on x86 with SSE2 row and column
+ * filters take one vector register each, so all eight are updated with
+ * two multiply-subtract-add steps per sample. Other targets use a scalar
+ * loop. Digit must be present in two
+ * consecutive blocks to be reported, and two blocks without digit end
+ * it. Detected digits are queued by the media thread and dispatched from
+ * the pjsip timer heap through the same path as RFC 2833 digits.
+ *
+ * In-band digits are sent with dll_dialDtmf mode 2 through a tone
+ * generator connected to the call's conference slot. Generator is
+ * created on first use and reused for all digits of the call until
+ * the call disconnects. It is created, reconnected, played and destroyed
+ * under generator mutex.
+ *
+ * SIP INFO digits (dll_dialDtmf mode 0) are sent one digit per INFO with
+ * application/dtmf-relay body "Signal=<digit>\r\nDuration=<msec>\r\n".
+ * Digits are queued per call and paced by a timer, so peers receive
+ * them at the rate of key presses instead of all in one body.
+ */
+
+#include "pjsipDll_Dtmf.h"
+#include <pjsua-lib/pjsua.h>
+#include <string.h>
+#include <math.h>
+
+#if defined(_M_X64) || defined(__x86_64__) || defined(__SSE2__)
+#	include <emmintrin.h>
+#	define INBAND_SSE2		1
+#elif defined(_MSC_VER) && defined(_M_IX86)
+	// SSE2 intrinsics are available, CPU support is checked in dtmf_init()
+#	include <windows.h>
+#	include <emmintrin.h>
+#	define INBAND_SSE2		1
+#	define INBAND_SSE2_CHECK	1
+#endif
+
+#define THIS_FILE	"pjsipDll_Dtmf.cpp"
+#define MAX_COLLECT_DIGITS	64
+#define MAX_TERMINATORS		16
+#define SIGNATURE		PJMEDIA_PORT_SIGNATURE('S', 'D', 'T', 'D')
+#define INBAND_FILTERS		8
+#define INBAND_BLOCK_8K		102	/* 12.75 msec at 8 kHz		    */
+#define INBAND_MIN_LEVEL	200	/* amplitude of weaker tone	    */
+#define INBAND_ROW_TWIST	6.3f	/* row tone up to 8 dB stronger	    */
+#define INBAND_COL_TWIST	2.5f	/* col tone up to 4 dB stronger	    */
+#define INBAND_RELATIVE_PEAK	6.3f	/* 8 dB above other tones in group  */
+#define INBAND_MAX_PENDING	16
+#define INBAND_TONE_ON_MSEC	100
+#define INBAND_TONE_OFF_MSEC	100
+#define INFO_DURATION		160	/* Duration= of INFO digits	    */
+#define INFO_INTERVAL		250	/* msec between INFO requests	    */
+#define INFO_MAX_QUEUED		64
+
+static const float inband_freq[INBAND_FILTERS] =
+{
+	697.0f, 770.0f, 852.0f, 941.0f, 1209.0f, 1336.0f, 1477.0f, 1633.0f
+};
+
+static const char inband_digit[16] =
+{
+	'1', '2', '3', 'A',
+	'4', '5', '6', 'B',
+	'7', '8', '9', 'C',
+	'*', '0', '#', 'D'
+};
+
+/* Check that character is DTMF digit */
+static pj_bool_t dtmf_is_digit(char digit)
+{
+	return digit != 0 && strchr("0123456789*#ABCD", digit) != NULL;
+}
+
+/* Digit collector, one per call */
+struct digit_collector
+{
+	pj_bool_t	    active;
+	int		    max_digits;
+	unsigned	    first_timeout;	/* msec, 0 waits forever    */
+	unsigned	    inter_digit;	/* msec, 0 waits forever    */
+	char		    terminators[MAX_TERMINATORS+1];
+	char		    digits[MAX_COLLECT_DIGITS+1];
+	int		    count;
+	pj_bool_t	    has_deadline;
+	pj_time_val	    deadline;
+
+	/* finished collection waiting for timer heap */
+	pj_bool_t	    done;
+	int		    reason;
+	char		    result[MAX_COLLECT_DIGITS+1];
+
+	pj_bool_t	    scheduled;
+};
+
+/* In-band detector port, receives audio of the call */
+struct inband_det
+{
+	pjmedia_port	    base;
+	pj_pool_t	   *pool;
+	int		    call_id;
+	pjsua_conf_port_id  slot;
+
+	unsigned	    block_size;
+	unsigned	    count;
+	float		    min_power;
+	float		    coef[INBAND_FILTERS];
+	float		    s1[INBAND_FILTERS];
+	float		    s2[INBAND_FILTERS];
+	float		    energy;
+	char		    last;		/* digit of previous block  */
+	char		    current;		/* digit being reported	    */
+
+	InbandDtmfStats	    stats;
+};
+
+/* In-band DTMF state of a call, detected digits wait here for timer heap */
+struct inband_call
+{
+	inband_det	   *det;
+	char		    pending[INBAND_MAX_PENDING];
+	unsigned	    pending_cnt;
+	pj_bool_t	    scheduled;
+
+	/* generator used by dll_dialDtmf */
+	pj_pool_t	   *gen_pool;
+	pjmedia_port	   *gen;
+	pjsua_conf_port_id  gen_slot;
+};
+
+/* SIP INFO digits waiting to be sent */
+struct info_call
+{
+	char		    queue[INFO_MAX_QUEUED];
+	unsigned	    head;
+	unsigned	    count;
+	pj_bool_t	    scheduled;	/* timer keeps pace even when empty */
+};
+
+static struct dtmf_data
+{
+	pj_pool_t	   *pool;
+	pj_mutex_t	   *mutex;
+	pj_mutex_t	   *gen_mutex;	/* generators, held across bridge calls */
+	pj_bool_t	    simd;
+	void		  (*on_digit)(int callId, int digit);
+	void		  (*on_call_source)(int callId);	/* generator connected to call */
+	digit_collector	    collect[PJSUA_MAX_CALLS];
+	pj_timer_entry	    collect_timer[PJSUA_MAX_CALLS];
+	inband_call	    inband[PJSUA_MAX_CALLS];
+	pj_timer_entry	    inband_timer[PJSUA_MAX_CALLS];
+	info_call	    info[PJSUA_MAX_CALLS];
+	pj_timer_entry	    info_timer[PJSUA_MAX_CALLS];
+} dtmf;
+
+// in-band detection may be enabled before dll_init
+static pj_bool_t inband_acc[PJSUA_MAX_ACC];
+
+static fptr_digitscollected* cb_digitscollected = 0;
+
+
+//////////////////////////////////////////////////////////////////////////
+// In-band detection
+
+/* Dispatch digits detected in call audio, runs in pjsip worker */
+static void inband_timer_cb(pj_timer_heap_t *timer_heap, struct pj_timer_entry *entry)
+{
+	int call_id = entry->id;
+	inband_call *ic = &dtmf.inband[call_id];
+	char digits[INBAND_MAX_PENDING];
+	unsigned i, cnt;
+
+	PJ_UNUSED_ARG(timer_heap);
+
+	pj_mutex_lock(dtmf.mutex);
+	ic->scheduled = PJ_FALSE;
+	cnt = ic->pending_cnt;
+	pj_memcpy(digits, ic->pending, cnt);
+	ic->pending_cnt = 0;
+	pj_mutex_unlock(dtmf.mutex);
+
+	for (i=0; i<cnt; ++i)
+		(*dtmf.on_digit)(call_id, digits[i]);
+}
+
+/* Queue detected digit for timer heap, called from media thread */
+static void inband_report(inband_det *det, char digit)
+{
+	inband_call *ic = &dtmf.inband[det->call_id];
+	pj_time_val delay = {0, 0};
+
+	++det->stats.digits;
+
+	pj_mutex_lock(dtmf.mutex);
+	if (ic->pending_cnt < INBAND_MAX_PENDING)
+		ic->pending[ic->pending_cnt++] = digit;
+	if (!ic->scheduled &&
+	    pjsip_endpt_schedule_timer(pjsua_get_pjsip_endpt(), &dtmf.inband_timer[det->call_id],
+				       &delay) == PJ_SUCCESS)
+	{
+		ic->scheduled = PJ_TRUE;
+	}
+	pj_mutex_unlock(dtmf.mutex);
+}
+
+/* Evaluate filters at the end of block. Returns detected digit or 0 */
+static char inband_block_digit(inband_det *det)
+{
+	float power[INBAND_FILTERS];
+	float r, c;
+	unsigned k, row, col;
+
+	for (k=0; k<INBAND_FILTERS; ++k) {
+		power[k] = det->s1[k] * det->s1[k] + det->s2[k] * det->s2[k] -
+			   det->coef[k] * det->s1[k] * det->s2[k];
+	}
+
+	row = 0;
+	col = 4;
+	for (k=1; k<4; ++k) {
+		if (power[k] > power[row])
+			row = k;
+		if (power[k+4] > power[col])
+			col = k+4;
+	}
+	r = power[row];
+	c = power[col];
+
+	if (r < det->min_power || c < det->min_power)
+		return 0;
+
+	if (r > c * INBAND_ROW_TWIST || c > r * INBAND_COL_TWIST)
+		return 0;
+
+	for (k=0; k<INBAND_FILTERS; ++k) {
+		if (k == row || k == col)
+			continue;
+		if (power[k] * INBAND_RELATIVE_PEAK > (k < 4 ? r : c))
+			return 0;
+	}
+
+	// pure tone pair gives r+c == energy*N/2, speech spreads wider
+	if ((r + c) * 4 < det->energy * det->block_size)
+		return 0;
+
+	return inband_digit[row * 4 + (col - 4)];
+}
+
+/* Run samples through all filters, samples must not cross block end */
+static void inband_filter(inband_det *det, const pj_int16_t *samples, unsigned count)
+{
+	unsigned i, k;
+
+	for (i=0; i<count; ++i) {
+		float x = samples[i];
+
+		det->energy += x * x;
+		for (k=0; k<INBAND_FILTERS; ++k) {
+			float s0 = det->coef[k] * det->s1[k] - det->s2[k] + x;
+			det->s2[k] = det->s1[k];
+			det->s1[k] = s0;
+		}
+	}
+}
+
+#if defined(INBAND_SSE2)
+/* Same as inband_filter, row filters in one register, column in other */
+static void inband_filter_sse2(inband_det *det, const pj_int16_t *samples, unsigned count)
+{
+	__m128 row_coef = _mm_loadu_ps(det->coef);
+	__m128 col_coef = _mm_loadu_ps(det->coef + 4);
+	__m128 row_s1 = _mm_loadu_ps(det->s1);
+	__m128 col_s1 = _mm_loadu_ps(det->s1 + 4);
+	__m128 row_s2 = _mm_loadu_ps(det->s2);
+	__m128 col_s2 = _mm_loadu_ps(det->s2 + 4);
+	float energy = det->energy;
+	unsigned i;
+
+	for (i=0; i<count; ++i) {
+		float x = samples[i];
+		__m128 vx = _mm_set1_ps(x);
+		__m128 row_s0 = _mm_add_ps(_mm_sub_ps(_mm_mul_ps(row_coef, row_s1), row_s2), vx);
+		__m128 col_s0 = _mm_add_ps(_mm_sub_ps(_mm_mul_ps(col_coef, col_s1), col_s2), vx);
+
+		energy += x * x;
+		row_s2 = row_s1;
+		col_s2 = col_s1;
+		row_s1 = row_s0;
+		col_s1 = col_s0;
+	}
+
+	_mm_storeu_ps(det->s1, row_s1);
+	_mm_storeu_ps(det->s1 + 4, col_s1);
+	_mm_storeu_ps(det->s2, row_s2);
+	_mm_storeu_ps(det->s2 + 4, col_s2);
+	det->energy = energy;
+}
+#endif
+
+static void inband_process(inband_det *det, const pj_int16_t *samples, unsigned count)
+{
+	unsigned i = 0, n, k;
+	char digit;
+
+	while (i < count) {
+		n = det->block_size - det->count;
+		if (n > count - i)
+			n = count - i;
+
+#if defined(INBAND_SSE2)
+		if (dtmf.simd)
+			inband_filter_sse2(det, samples + i, n);
+		else
+#endif
+			inband_filter(det, samples + i, n);
+
+		i += n;
+		det->count += n;
+		if (det->count < det->block_size)
+			continue;
+
+		digit = inband_block_digit(det);
+
+		if (digit != 0 && digit == det->last && digit != det->current) {
+			det->current = digit;
+			inband_report(det, digit);
+		} else if (digit == 0 && det->last == 0) {
+			det->current = 0;
+		}
+		det->last = digit;
+
+		det->count = 0;
+		det->energy = 0;
+		for (k=0; k<INBAND_FILTERS; ++k)
+			det->s1[k] = det->s2[k] = 0;
+	}
+}
+
+static pj_status_t inband_put_frame(pjmedia_port *this_port, const pjmedia_frame *frame)
+{
+	inband_det *det = (inband_det*) this_port;
+	pj_timestamp t0, t1;
+	pj_uint32_t usec;
+
+	if (frame->type != PJMEDIA_FRAME_TYPE_AUDIO)
+		return PJ_SUCCESS;
+
+	pj_get_timestamp(&t0);
+	inband_process(det, (const pj_int16_t*) frame->buf, frame->size / sizeof(pj_int16_t));
+	pj_get_timestamp(&t1);
+
+	usec = pj_elapsed_usec(&t0, &t1);
+	++det->stats.frames;
+	det->stats.cpuUsec += usec;
+	if ((int)usec > det->stats.maxFrameUsec)
+		det->stats.maxFrameUsec = usec;
+
+	return PJ_SUCCESS;
+}
+
+static pj_status_t inband_create(int call_id, inband_det **p_det)
+{
+	pjsua_conf_port_info master;
+	pj_pool_t *pool;
+	inband_det *det;
+	pj_str_t name = pj_str((char*)"inband-dtmf");
+	unsigned k;
+	float level;
+	pj_status_t status;
+
+	status = pjsua_conf_get_port_info(0, &master);
+	if (status != PJ_SUCCESS)
+		return status;
+
+	pool = pjsua_pool_create("inband", 1000, 1000);
+	det = PJ_POOL_ZALLOC_T(pool, inband_det);
+	det->pool = pool;
+	det->call_id = call_id;
+	det->block_size = master.clock_rate * INBAND_BLOCK_8K / 8000;
+	for (k=0; k<INBAND_FILTERS; ++k)
+		det->coef[k] = (float)(2.0 * cos(2.0 * 3.14159265358979 * inband_freq[k] / master.clock_rate));
+
+	// Goertzel power of tone with amplitude A is (A*N/2)^2
+	level = INBAND_MIN_LEVEL * det->block_size / 2.0f;
+	det->min_power = level * level;
+
+	pjmedia_port_info_init(&det->base.info, &name, SIGNATURE, master.clock_rate,
+			       1, 16, master.samples_per_frame / master.channel_count);
+	det->base.put_frame = &inband_put_frame;
+
+	status = pjsua_conf_add_port(pool, &det->base, &det->slot);
+	if (status != PJ_SUCCESS) {
+		pj_pool_release(pool);
+		return status;
+	}
+
+	*p_det = det;
+	return PJ_SUCCESS;
+}
+
+/* Remove detector from the bridge and free it, must not be published */
+static void inband_destroy(inband_det *det)
+{
+	// media thread doesn't call the port after it is removed from bridge
+	pjsua_conf_remove_port(det->slot);
+	pj_pool_release(det->pool);
+}
+
+/* Detector is taken out under mutex, so stats readers never see it freed */
+static void inband_detach(int call_id)
+{
+	inband_call *ic = &dtmf.inband[call_id];
+	inband_det *det;
+
+	// forget digits not dispatched yet
+	pj_mutex_lock(dtmf.mutex);
+	det = ic->det;
+	ic->det = NULL;
+	if (ic->scheduled) {
+		pjsip_endpt_cancel_timer(pjsua_get_pjsip_endpt(), &dtmf.inband_timer[call_id]);
+		ic->scheduled = PJ_FALSE;
+	}
+	ic->pending_cnt = 0;
+	pj_mutex_unlock(dtmf.mutex);
+
+	if (det)
+		inband_destroy(det);
+}
+
+/* Create tone generator of the call and connect it to the call.
+ * Generator mutex must be held. It is a separate mutex because the
+ * bridge calls the detector, which takes dtmf.mutex, with the bridge
+ * mutex held.
+ */
+static pj_status_t inband_gen_create(int call_id, pjsua_conf_port_id call_slot)
+{
+	inband_call *ic = &dtmf.inband[call_id];
+	pjsua_conf_port_info master;
+	pj_str_t name = pj_str((char*)"inband-dtmf-gen");
+	pj_status_t status;
+
+	status = pjsua_conf_get_port_info(0, &master);
+	if (status != PJ_SUCCESS)
+		return status;
+
+	ic->gen_pool = pjsua_pool_create("inbandgen", 1000, 1000);
+	status = pjmedia_tonegen_create2(ic->gen_pool, &name, master.clock_rate, 1,
+					 master.samples_per_frame / master.channel_count,
+					 16, 0, &ic->gen);
+	if (status != PJ_SUCCESS)
+		goto on_error;
+
+	status = pjsua_conf_add_port(ic->gen_pool, ic->gen, &ic->gen_slot);
+	if (status != PJ_SUCCESS)
+		goto on_error;
+
+	status = pjsua_conf_connect(ic->gen_slot, call_slot);
+	if (status != PJ_SUCCESS) {
+		pjsua_conf_remove_port(ic->gen_slot);
+		goto on_error;
+	}
+
+	return PJ_SUCCESS;
+
+on_error:
+	if (ic->gen)
+		pjmedia_port_destroy(ic->gen);
+	pj_pool_release(ic->gen_pool);
+	ic->gen = NULL;
+	ic->gen_pool = NULL;
+	return status;
+}
+
+static void inband_gen_destroy(int call_id)
+{
+	inband_call *ic = &dtmf.inband[call_id];
+
+	pj_mutex_lock(dtmf.gen_mutex);
+	if (ic->gen) {
+		pjsua_conf_remove_port(ic->gen_slot);
+		pjmedia_port_destroy(ic->gen);
+		pj_pool_release(ic->gen_pool);
+		ic->gen = NULL;
+		ic->gen_pool = NULL;
+	}
+	pj_mutex_unlock(dtmf.gen_mutex);
+}
+
+/* Send digits as tones, used by dll_dialDtmf mode 2. Digits are appended
+ * to the ones still playing.
+ */
+int dtmf_play_inband(int callId, const char* digits)
+{
+	pjmedia_tone_digit tones[PJMEDIA_TONEGEN_MAX_DIGITS];
+	inband_call *ic;
+	pjsua_conf_port_id call_slot;
+	pj_bool_t created = PJ_FALSE;
+	unsigned count = 0;
+	pj_status_t status;
+
+	if (callId < 0 || callId >= PJSUA_MAX_CALLS || digits == NULL || dtmf.mutex == NULL)
+		return PJ_EINVAL;
+
+	if (!pjsua_call_has_media(callId))
+		return PJ_EINVALIDOP;
+
+	// pjsua locks the call, look it up before generator mutex is taken
+	call_slot = pjsua_call_get_conf_port(callId);
+	ic = &dtmf.inband[callId];
+
+	for (; *digits && count < PJ_ARRAY_SIZE(tones); ++digits) {
+		if (!dtmf_is_digit(*digits))
+			continue;
+		tones[count].digit = *digits;
+		tones[count].on_msec = INBAND_TONE_ON_MSEC;
+		tones[count].off_msec = INBAND_TONE_OFF_MSEC;
+		tones[count].volume = 0;
+		++count;
+	}
+
+	if (count == 0)
+		return PJ_EINVAL;
+
+	pj_mutex_lock(dtmf.gen_mutex);
+	if (ic->gen == NULL) {
+		status = inband_gen_create(callId, call_slot);
+		if (status != PJ_SUCCESS) {
+			pj_mutex_unlock(dtmf.gen_mutex);
+			pjsua_perror(THIS_FILE, "Unable to create in-band DTMF generator", status);
+			return status;
+		}
+		created = PJ_TRUE;
+	}
+	status = pjmedia_tonegen_play_digits(ic->gen, count, tones, 0);
+	pj_mutex_unlock(dtmf.gen_mutex);
+
+	// let recorder pick up the new source, pjsua locks the call
+	if (created && dtmf.on_call_source)
+		(*dtmf.on_call_source)(callId);
+
+	return status;
+}
+
+/* Reconnect tone generator after media update (re-INVITE, hold/retrieve)
+ * and attach detector when the account has in-band detection.
+ */
+void dtmf_on_call_media(int callId)
+{
+	pjsua_call_info ci;
+	inband_call *ic;
+	inband_det *det = NULL;
+	pjsua_conf_port_id det_slot = PJSUA_INVALID_ID;
+
+	if (callId < 0 || callId >= PJSUA_MAX_CALLS || dtmf.mutex == NULL)
+		return;
+
+	if (!pjsua_call_has_media(callId) || pjsua_call_get_info(callId, &ci) != PJ_SUCCESS)
+		return;
+
+	ic = &dtmf.inband[callId];
+	pj_mutex_lock(dtmf.gen_mutex);
+	if (ic->gen != NULL)
+		pjsua_conf_connect(ic->gen_slot, ci.conf_slot);
+	pj_mutex_unlock(dtmf.gen_mutex);
+
+	if (ci.acc_id < 0 || ci.acc_id >= PJSUA_MAX_ACC || !inband_acc[ci.acc_id])
+		return;
+
+	pj_mutex_lock(dtmf.mutex);
+	if (ic->det)
+		det_slot = ic->det->slot;
+	pj_mutex_unlock(dtmf.mutex);
+
+	if (det_slot == PJSUA_INVALID_ID) {
+		if (inband_create(callId, &det) != PJ_SUCCESS) {
+			PJ_LOG(2,(THIS_FILE, "Unable to create in-band DTMF detector for call %d", callId));
+			return;
+		}
+
+		// publish new detector, keep the one published meanwhile
+		pj_mutex_lock(dtmf.mutex);
+		if (ic->det == NULL) {
+			ic->det = det;
+			det = NULL;
+		}
+		det_slot = ic->det->slot;
+		pj_mutex_unlock(dtmf.mutex);
+
+		if (det)
+			inband_destroy(det);
+	}
+
+	pjsua_conf_connect(ci.conf_slot, det_slot);
+}
+
+
+//////////////////////////////////////////////////////////////////////////
+// SIP INFO digits
+
+/* Send one digit in INFO request. Must be called without mutex held,
+ * pjsua locks the dialog.
+ */
+static pj_status_t info_send_digit(int call_id, char digit)
+{
+	char body[48];
+	pj_str_t method = pj_str((char*)"INFO");
+	pjsua_msg_data msg_data;
+	int len;
+	pj_status_t status;
+
+	len = pj_ansi_snprintf(body, sizeof(body), "Signal=%c\r\nDuration=%d\r\n",
+			       digit, INFO_DURATION);
+
+	pjsua_msg_data_init(&msg_data);
+	msg_data.content_type = pj_str((char*)"application/dtmf-relay");
+	msg_data.msg_body.ptr = body;
+	msg_data.msg_body.slen = len;
+
+	status = pjsua_call_send_request(call_id, &method, &msg_data);
+	if (status != PJ_SUCCESS)
+		pjsua_perror(THIS_FILE, "Unable to send INFO DTMF", status);
+
+	return status;
+}
+
+/* Take next digit and keep the pace. Mutex must be held. Returns 0 when
+ * queue is empty.
+ */
+static char info_next_digit(int call_id)
+{
+	info_call *ic = &dtmf.info[call_id];
+	pj_time_val delay = {0, INFO_INTERVAL};
+	char digit;
+
+	if (ic->count == 0)
+		return 0;
+
+	digit = ic->queue[ic->head];
+	ic->head = (ic->head + 1) % INFO_MAX_QUEUED;
+	--ic->count;
+
+	PJ_TIME_VAL_NORMALIZE(delay);
+	if (pjsip_endpt_schedule_timer(pjsua_get_pjsip_endpt(), &dtmf.info_timer[call_id],
+				       &delay) == PJ_SUCCESS)
+	{
+		ic->scheduled = PJ_TRUE;
+	}
+
+	return digit;
+}
+
+/* Send next queued digit, runs in pjsip worker */
+static void info_timer_cb(pj_timer_heap_t *timer_heap, struct pj_timer_entry *entry)
+{
+	int call_id = entry->id;
+	char digit;
+
+	PJ_UNUSED_ARG(timer_heap);
+
+	pj_mutex_lock(dtmf.mutex);
+	dtmf.info[call_id].scheduled = PJ_FALSE;
+	digit = info_next_digit(call_id);
+	pj_mutex_unlock(dtmf.mutex);
+
+	if (digit)
+		info_send_digit(call_id, digit);
+}
+
+/* Queue digits to be sent in INFO requests, used by dll_dialDtmf mode 0.
+ * When no INFO digit was sent recently, first digit is sent at once.
+ */
+int dtmf_send_info(int callId, const char* digits)
+{
+	info_call *ic;
+	char first = 0;
+	pj_status_t status = PJ_SUCCESS;
+
+	if (callId < 0 || callId >= PJSUA_MAX_CALLS || digits == NULL || dtmf.mutex == NULL)
+		return PJ_EINVAL;
+
+	if (!pjsua_call_is_active(callId))
+		return PJ_EINVALIDOP;
+
+	ic = &dtmf.info[callId];
+
+	pj_mutex_lock(dtmf.mutex);
+	for (; *digits; ++digits) {
+		if (!dtmf_is_digit(*digits))
+			continue;
+		if (ic->count == INFO_MAX_QUEUED) {
+			status = PJ_ETOOMANY;
+			break;
+		}
+		ic->queue[(ic->head + ic->count) % INFO_MAX_QUEUED] = *digits;
+		++ic->count;
+	}
+	if (!ic->scheduled)
+		first = info_next_digit(callId);
+	pj_mutex_unlock(dtmf.mutex);
+
+	if (first) {
+		pj_status_t st = info_send_digit(callId, first);
+		if (status == PJ_SUCCESS)
+			status = st;
+	}
+
+	return status;
+}
+
+static void info_clear(int call_id)
+{
+	info_call *ic = &dtmf.info[call_id];
+
+	pj_mutex_lock(dtmf.mutex);
+	if (ic->scheduled) {
+		pjsip_endpt_cancel_timer(pjsua_get_pjsip_endpt(), &dtmf.info_timer[call_id]);
+		ic->scheduled = PJ_FALSE;
+	}
+	ic->head = ic->count = 0;
+	pj_mutex_unlock(dtmf.mutex);
+}
+
+
+//////////////////////////////////////////////////////////////////////////
+// Digit collection
+
+/* Schedule collector timer after delay msec. Mutex must be held */
+static void collect_schedule(int call_id, unsigned msec)
+{
+	digit_collector *c = &dtmf.collect[call_id];
+	pj_time_val delay;
+
+	if (c->scheduled) {
+		// nothing cancelled means the callback is about to run and wait
+		// for the mutex, it handles current state, entry must not be
+		// scheduled twice
+		if (pj_timer_heap_cancel(pjsip_endpt_get_timer_heap(pjsua_get_pjsip_endpt()),
+					 &dtmf.collect_timer[call_id]) == 0)
+		{
+			return;
+		}
+		c->scheduled = PJ_FALSE;
+	}
+
+	delay.sec = msec / 1000;
+	delay.msec = msec % 1000;
+
+	if (pjsip_endpt_schedule_timer(pjsua_get_pjsip_endpt(), &dtmf.collect_timer[call_id],
+				       &delay) == PJ_SUCCESS)
+		c->scheduled = PJ_TRUE;
+}
+
+/* Move deadline msec from now. Mutex must be held */
+static void collect_set_deadline(digit_collector *c, unsigned msec)
+{
+	if (msec == 0) {
+		c->has_deadline = PJ_FALSE;
+		return;
+	}
+
+	pj_gettickcount(&c->deadline);
+	c->deadline.sec += msec / 1000;
+	c->deadline.msec += msec % 1000;
+	PJ_TIME_VAL_NORMALIZE(c->deadline);
+	c->has_deadline = PJ_TRUE;
+}
+
+/* Finish collection and report it from timer heap. Mutex must be held */
+static void collect_finish(int call_id, int reason)
+{
+	digit_collector *c = &dtmf.collect[call_id];
+
+	c->active = PJ_FALSE;
+	c->has_deadline = PJ_FALSE;
+	c->done = PJ_TRUE;
+	c->reason = reason;
+	pj_memcpy(c->result, c->digits, c->count);
+	c->result[c->count] = '\0';
+
+	collect_schedule(call_id, 0);
+}
+
+/* Deliver finished collection or check deadline, runs in pjsip worker */
+static void collect_timer_cb(pj_timer_heap_t *timer_heap, struct pj_timer_entry *entry)
+{
+	int call_id = entry->id;
+	digit_collector *c = &dtmf.collect[call_id];
+	char digits[MAX_COLLECT_DIGITS+1];
+	int reason = -1;
+	pj_time_val now;
+
+	PJ_UNUSED_ARG(timer_heap);
+
+	pj_mutex_lock(dtmf.mutex);
+	c->scheduled = PJ_FALSE;
+
+	if (c->done) {
+		c->done = PJ_FALSE;
+		reason = c->reason;
+		pj_ansi_strcpy(digits, c->result);
+	}
+
+	if (c->active && c->has_deadline) {
+		pj_gettickcount(&now);
+		if (PJ_TIME_VAL_GTE(now, c->deadline)) {
+			if (reason < 0) {
+				c->active = PJ_FALSE;
+				c->has_deadline = PJ_FALSE;
+				reason = c->count ? DC_INTERDIGIT_TIMEOUT : DC_FIRST_TIMEOUT;
+				pj_memcpy(digits, c->digits, c->count);
+				digits[c->count] = '\0';
+			} else {
+				/* report timeout of new collection next */
+				collect_schedule(call_id, 0);
+			}
+		} else {
+			/* digit moved the deadline, wait for the rest */
+			pj_time_val left = c->deadline;
+			PJ_TIME_VAL_SUB(left, now);
+			collect_schedule(call_id, PJ_TIME_VAL_MSEC(left));
+		}
+	}
+	pj_mutex_unlock(dtmf.mutex);
+
+	if (reason >= 0 && cb_digitscollected != 0)
+		(*cb_digitscollected)(call_id, digits, reason);
+}
+
+/* Buffer digit when collection is active on the call. Returns nonzero
+ * when digit was consumed by collector.
+ */
+int dtmf_on_digit(int callId, int digit)
+{
+	digit_collector *c;
+
+	if (callId < 0 || callId >= PJSUA_MAX_CALLS || dtmf.mutex == NULL)
+		return 0;
+
+	c = &dtmf.collect[callId];
+
+	pj_mutex_lock(dtmf.mutex);
+	if (!c->active) {
+		pj_mutex_unlock(dtmf.mutex);
+		return 0;
+	}
+
+	if (digit != 0 && strchr(c->terminators, digit) != NULL) {
+		collect_finish(callId, DC_TERMINATOR);
+	} else {
+		c->digits[c->count++] = (char) digit;
+		if (c->count >= c->max_digits)
+			collect_finish(callId, DC_MAX_DIGITS);
+		else {
+			collect_set_deadline(c, c->inter_digit);
+			/* a pending result is reported first, its timer
+			 * callback picks up the new deadline */
+			if (c->has_deadline && !c->done)
+				collect_schedule(callId, c->inter_digit);
+		}
+	}
+	pj_mutex_unlock(dtmf.mutex);
+
+	return 1;
+}
+
+void dtmf_on_call_disconnected(int callId)
+{
+	if (callId < 0 || callId >= PJSUA_MAX_CALLS || dtmf.mutex == NULL)
+		return;
+
+	inband_detach(callId);
+	inband_gen_destroy(callId);
+	info_clear(callId);
+
+	pj_mutex_lock(dtmf.mutex);
+	if (dtmf.collect[callId].active)
+		collect_finish(callId, DC_DISCONNECTED);
+	pj_mutex_unlock(dtmf.mutex);
+}
+
+
+//////////////////////////////////////////////////////////////////////////
+// Init/destroy
+
+int dtmf_init(void (*on_digit)(int callId, int digit),
+	      void (*on_call_source)(int callId))
+{
+	pj_status_t status;
+	unsigned i;
+
+	pj_bzero(&dtmf, sizeof(dtmf));
+	dtmf.on_digit = on_digit;
+	dtmf.on_call_source = on_call_source;
+
+	dtmf.pool = pjsua_pool_create("dtmf", 1000, 1000);
+
+	status = pj_mutex_create_simple(dtmf.pool, "dtmf", &dtmf.mutex);
+	if (status != PJ_SUCCESS)
+		return status;
+
+	status = pj_mutex_create_simple(dtmf.pool, "dtmfgen", &dtmf.gen_mutex);
+	if (status != PJ_SUCCESS) {
+		pj_mutex_destroy(dtmf.mutex);
+		dtmf.mutex = NULL;
+		return status;
+	}
+
+#if defined(INBAND_SSE2_CHECK)
+	dtmf.simd = IsProcessorFeaturePresent(PF_XMMI64_INSTRUCTIONS_AVAILABLE) ? PJ_TRUE : PJ_FALSE;
+#elif defined(INBAND_SSE2)
+	dtmf.simd = PJ_TRUE;
+#endif
+
+	for (i=0; i<PJ_ARRAY_SIZE(dtmf.collect_timer); ++i)
+		pj_timer_entry_init(&dtmf.collect_timer[i], i, NULL, &collect_timer_cb);
+	for (i=0; i<PJ_ARRAY_SIZE(dtmf.inband_timer); ++i)
+		pj_timer_entry_init(&dtmf.inband_timer[i], i, NULL, &inband_timer_cb);
+	for (i=0; i<PJ_ARRAY_SIZE(dtmf.info_timer); ++i)
+		pj_timer_entry_init(&dtmf.info_timer[i], i, NULL, &info_timer_cb);
+
+	return PJ_SUCCESS;
+}
+
+void dtmf_destroy(void)
+{
+	unsigned i;
+
+	if (dtmf.pool == NULL)
+		return;
+
+	for (i=0; i<PJ_ARRAY_SIZE(dtmf.collect); ++i) {
+		inband_detach(i);
+		inband_gen_destroy(i);
+		info_clear(i);
+		if (dtmf.collect[i].scheduled)
+			pjsip_endpt_cancel_timer(pjsua_get_pjsip_endpt(), &dtmf.collect_timer[i]);
+	}
+
+	if (dtmf.gen_mutex)
+		pj_mutex_destroy(dtmf.gen_mutex);
+	if (dtmf.mutex)
+		pj_mutex_destroy(dtmf.mutex);
+	pj_pool_release(dtmf.pool);
+	pj_bzero(&dtmf, sizeof(dtmf));
+}
+
+
+//////////////////////////////////////////////////////////////////////////
+// API
+
+int onDigitsCollectedCallback(fptr_digitscollected cb)
+{
+	cb_digitscollected = cb;
+	return 1;
+}
+
+/* Start collecting digits on call. Collection already running on the call
+ * is finished with DC_CANCELLED. Terminator digits finish collection and
+ * are not included in collected digits.
+ */
+int dll_collectDigits(int callId, int maxDigits, int firstTimeoutMs, int interDigitMs, char* terminators)
+{
+	digit_collector *c;
+
+	if (callId < 0 || callId >= PJSUA_MAX_CALLS || dtmf.mutex == NULL)
+		return -1;
+
+	if (!pjsua_call_is_active(callId))
+		return -1;
+
+	if (maxDigits <= 0 || maxDigits > MAX_COLLECT_DIGITS)
+		maxDigits = MAX_COLLECT_DIGITS;
+
+	c = &dtmf.collect[callId];
+
+	pj_mutex_lock(dtmf.mutex);
+	if (c->active)
+		collect_finish(callId, DC_CANCELLED);
+
+	c->max_digits = maxDigits;
+	c->first_timeout = firstTimeoutMs > 0 ? firstTimeoutMs : 0;
+	c->inter_digit = interDigitMs > 0 ? interDigitMs : 0;
+	c->terminators[0] = '\0';
+	if (terminators)
+		pj_ansi_strncpy(c->terminators, terminators, MAX_TERMINATORS);
+	c->terminators[MAX_TERMINATORS] = '\0';
+	c->count = 0;
+	c->active = PJ_TRUE;
+
+	collect_set_deadline(c, c->first_timeout);
+	/* pending result is delivered first and timer is rescheduled then */
+	if (c->has_deadline && !c->done)
+		collect_schedule(callId, c->first_timeout);
+	pj_mutex_unlock(dtmf.mutex);
+
+	return PJ_SUCCESS;
+}
+
+int dll_cancelCollectDigits(int callId)
+{
+	if (callId < 0 || callId >= PJSUA_MAX_CALLS || dtmf.mutex == NULL)
+		return -1;
+
+	pj_mutex_lock(dtmf.mutex);
+	if (!dtmf.collect[callId].active) {
+		pj_mutex_unlock(dtmf.mutex);
+		return -1;
+	}
+	collect_finish(callId, DC_CANCELLED);
+	pj_mutex_unlock(dtmf.mutex);
+
+	return PJ_SUCCESS;
+}
+
+int dll_setInbandDtmf(int accId, bool enable)
+{
+	if (accId < 0 || accId >= PJSUA_MAX_ACC)
+		return -1;
+
+	inband_acc[accId] = enable ? PJ_TRUE : PJ_FALSE;
+	return PJ_SUCCESS;
+}
+
+int dll_getInbandDtmfStats(int callId, InbandDtmfStats* stats)
+{
+	if (callId < 0 || callId >= PJSUA_MAX_CALLS || stats == NULL || dtmf.mutex == NULL)
+		return -1;
+
+	// detector is freed only after it is taken out under mutex
+	pj_mutex_lock(dtmf.mutex);
+	if (dtmf.inband[callId].det == NULL) {
+		pj_mutex_unlock(dtmf.mutex);
+		return -1;
+	}
+	*stats = dtmf.inband[callId].det->stats;
+	pj_mutex_unlock(dtmf.mutex);
+
+	return PJ_SUCCESS;
+}
@@ -0,0 +1,73 @@
+/*
+ * Copyright (C) 2007 Sasa Coh <sasacoh@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+// pjsipDll_Dtmf.h : DTMF digit collection, in-band and SIP INFO DTMF
+//
+
+#ifdef LINUX
+	#define __stdcall
+	#define PJSIPDLL_DLL_API
+#else
+#ifdef PJSIPDLL_EXPORTS
+	#define PJSIPDLL_DLL_API __declspec(dllexport)
+#else
+	#define PJSIPDLL_DLL_API __declspec(dllimport)
+#endif
+#endif
+
+// Reasons digit collection has finished
+enum EDigitCollectReason
+{
+	DC_MAX_DIGITS,			// maxDigits digits collected
+	DC_TERMINATOR,			// terminator digit pressed, not included in digits
+	DC_FIRST_TIMEOUT,		// no digit pressed
+	DC_INTERDIGIT_TIMEOUT,	// no digit after last one
+	DC_CANCELLED,			// dll_cancelCollectDigits or new collection
+	DC_DISCONNECTED			// call disconnected
+};
+
+// In-band detector statistics of a call
+struct InbandDtmfStats
+{
+	int frames;			// audio frames analyzed
+	int digits;			// digits detected
+	int cpuUsec;			// total time spent in detector
+	int maxFrameUsec;		// longest time spent on single frame
+};
+
+// calback function definitions
+typedef int __stdcall fptr_digitscollected(int callId, const char* digits, int reason);
+
+// Callback registration
+extern "C" PJSIPDLL_DLL_API int onDigitsCollectedCallback(fptr_digitscollected cb); // register digit collection notifier
+
+// DTMF API
+extern "C" PJSIPDLL_DLL_API int dll_collectDigits(int callId, int maxDigits, int firstTimeoutMs, int interDigitMs, char* terminators);
+extern "C" PJSIPDLL_DLL_API int dll_cancelCollectDigits(int callId);
+extern "C" PJSIPDLL_DLL_API int dll_setInbandDtmf(int accId, bool enable);
+extern "C" PJSIPDLL_DLL_API int dll_getInbandDtmfStats(int callId, InbandDtmfStats* stats);
+
+// Internal hooks called by pjsipDll.cpp
+int dtmf_init(void (*on_digit)(int callId, int digit),
+	      void (*on_call_source)(int callId));
+void dtmf_destroy(void);
+int dtmf_on_digit(int callId, int digit);
+void dtmf_on_call_media(int callId);
+int dtmf_play_inband(int callId, const char* digits);
+int dtmf_send_info(int callId, const char* digits);
+void dtmf_on_call_disconnected(int callId);
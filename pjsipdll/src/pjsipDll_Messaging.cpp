@@ -0,0 +1,783 @@
+/*
+ * Copyright (C) 2007 Sasa Coh <sasacoh@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * This code is based on pjsip from Benny Prijono <benny@prijono.org>
+ *
+ */
+
+/*
+ * Outbound instant message queue.
+ *
+ * dll_sendMessage sends MESSAGE at once and its result is lost. Queued
+ * messages get a token, are sent by a pump running on the pjsip timer
+ * heap and their final status is reported with onMessageStatusCallback.
+ *
+ * Throughput is limited in two places:
+ *  - each destination (URI, or call for call messages) gets at most one
+ *    message per destIntervalMs,
+ *  - the pump sends at most maxPerSecond messages overall, it earns send
+ *    credit for the time passed since its last run (token bucket).
+ * Messages failing with 408 or 503 are queued again at the front of
+ * their destination with exponential backoff, up to maxRetries times.
+ *
+ * Token encodes message slot, so status lookup needs no search. Message
+ * pointers are never passed to pjsua as user data, late status of a
+ * message that is already gone is ignored. Destination without messages
+ * is freed by the pump once its send interval has passed.
+ *
+ * Typing indications.
+ *
+ * Chat clients report typing on every key press. Sent and received
+ * indications are debounced per peer:
+ *  - "typing" is passed on when the peer was idle, repeated "typing"
+ *    is suppressed until TYPING_REFRESH,
+ *  - "idle" is delayed by the typing window and dropped when typing
+ *    resumes within it, so pauses between words are not seen.
+ * Delayed idle is sent or reported from the pjsip timer heap. Peer whose
+ * state didn't change for TYPING_EXPIRE is freed, a new one starts idle.
+ */
+
+#include "pjsipDll_Messaging.h"
+#include <pjsua-lib/pjsua.h>
+
+#define THIS_FILE	"pjsipDll_Messaging.cpp"
+#define IM_MAX_MESSAGES		4096	/* queued and in flight		    */
+#define IM_SLOT_BITS		12
+#define IM_PUMP_MSEC		20	/* pump period while queue not empty */
+#define IM_MAX_BATCH		64	/* messages sent by one pump run    */
+#define IM_HASH_SIZE		1024
+#define TYPING_REFRESH		60	/* sec before "typing" is repeated  */
+#define TYPING_EXPIRE		120	/* sec before unchanged peer is freed */
+#define TYPING_KEY_LEN		256
+
+struct im_dest;
+
+/* Queued message, allocated from its own pool */
+struct im_msg
+{
+	PJ_DECL_LIST_MEMBER(im_msg);
+	pj_pool_t	   *pool;
+	int		    token;
+	int		    acc_id;
+	int		    call_id;	/* -1 for out of dialog MESSAGE	    */
+	pj_str_t	    body;
+	unsigned	    retries;
+	pj_bool_t	    in_flight;
+	pj_time_val	    not_before;
+	im_dest		   *dest;
+};
+
+/* Destination with its pending messages, allocated from its own pool */
+struct im_dest
+{
+	PJ_DECL_LIST_MEMBER(im_dest);	/* ready or idle list	    */
+	pj_pool_t	   *pool;
+	pj_str_t	    uri;
+	im_msg		    pending;
+	unsigned	    msg_cnt;	/* queued and in flight		    */
+	pj_time_val	    next_send;
+	pj_bool_t	    ready;
+	pj_bool_t	    idle;
+};
+
+/* Typing state of a peer, allocated from its own pool */
+struct typing_peer
+{
+	PJ_DECL_LIST_MEMBER(typing_peer);
+	pj_pool_t	   *pool;
+	pj_str_t	    key;
+	pj_str_t	    uri;
+	int		    acc_id;
+	int		    call_id;
+	pj_bool_t	    outgoing;
+	pj_bool_t	    active;	/* state sent or reported	    */
+	pj_time_val	    last;	/* when state was sent or reported  */
+	pj_bool_t	    idle_pending;
+	pj_timer_entry	    timer;
+};
+
+static struct im_data
+{
+	pj_pool_t	   *pool;
+	pj_mutex_t	   *mutex;
+	pj_hash_table_t	   *dests;
+	im_dest		    ready;
+	im_dest		    idle;	/* no messages, freed after next_send */
+	im_msg		   *msgs[IM_MAX_MESSAGES];
+	unsigned	    free_slots[IM_MAX_MESSAGES];
+	unsigned	    free_cnt;
+	unsigned	    seq;
+	pj_timer_entry	    timer;
+	pj_bool_t	    scheduled;
+	unsigned	    credit;	/* send credit in 1/1000 message    */
+	pj_time_val	    last_pump;
+
+	pj_hash_table_t	   *typing;
+	typing_peer	    peers;
+} im;
+
+// queue may be configured before dll_init
+static struct im_config
+{
+	unsigned	    dest_interval;
+	unsigned	    max_per_second;
+	unsigned	    max_retries;
+	unsigned	    retry_delay;
+	unsigned	    typing_window;
+} im_cfg = { 200, 50, 3, 1000, 3000 };
+
+static fptr_messagestatus* cb_messagestatus = 0;
+static fptr_typing* cb_typing = 0;
+
+
+//////////////////////////////////////////////////////////////////////////
+// Queue
+
+static void time_add_msec(pj_time_val *t, unsigned msec)
+{
+	t->sec += msec / 1000;
+	t->msec += msec % 1000;
+	PJ_TIME_VAL_NORMALIZE(*t);
+}
+
+/* Schedule pump after msec, mutex must be held */
+static void im_schedule(unsigned msec)
+{
+	pj_time_val delay = {0, 0};
+
+	if (im.scheduled)
+		return;
+
+	time_add_msec(&delay, msec);
+	if (pjsip_endpt_schedule_timer(pjsua_get_pjsip_endpt(), &im.timer, &delay) == PJ_SUCCESS)
+		im.scheduled = PJ_TRUE;
+}
+
+/* Put destination on ready list, mutex must be held */
+static void im_dest_ready(im_dest *d)
+{
+	if (!d->ready) {
+		pj_list_push_back(&im.ready, d);
+		d->ready = PJ_TRUE;
+	}
+}
+
+/* Find or create destination, mutex must be held */
+static im_dest* im_get_dest(const char *key)
+{
+	pj_pool_t *pool;
+	im_dest *d;
+
+	d = (im_dest*) pj_hash_get(im.dests, key, PJ_HASH_KEY_STRING, NULL);
+	if (d) {
+		// idle destination keeps its pacing
+		if (d->idle) {
+			pj_list_erase(d);
+			d->idle = PJ_FALSE;
+		}
+		return d;
+	}
+
+	pool = pjsua_pool_create("imdest", 256, 256);
+	d = PJ_POOL_ZALLOC_T(pool, im_dest);
+	d->pool = pool;
+	pj_strdup2_with_null(pool, &d->uri, key);
+	pj_list_init(&d->pending);
+	// hash entry is allocated from destination pool too
+	pj_hash_set(pool, im.dests, d->uri.ptr, PJ_HASH_KEY_STRING, 0, d);
+
+	return d;
+}
+
+/* Destination has no messages left, it is freed by the pump once its
+ * send interval has passed. Mutex must be held
+ */
+static void im_dest_idle(im_dest *d)
+{
+	if (d->ready) {
+		pj_list_erase(d);
+		d->ready = PJ_FALSE;
+	}
+	pj_list_push_back(&im.idle, d);
+	d->idle = PJ_TRUE;
+}
+
+/* Free idle destinations which may send again, mutex must be held */
+static void im_dest_sweep(const pj_time_val *now)
+{
+	pj_time_val t = *now;
+	im_dest *d, *next;
+
+	for (d = im.idle.next; d != &im.idle; d = next) {
+		next = d->next;
+
+		if (PJ_TIME_VAL_LT(t, d->next_send))
+			continue;
+
+		pj_list_erase(d);
+		pj_hash_set(NULL, im.dests, d->uri.ptr, PJ_HASH_KEY_STRING, 0, NULL);
+		pj_pool_release(d->pool);
+	}
+}
+
+static im_msg* im_find(int token)
+{
+	unsigned slot = token & (IM_MAX_MESSAGES - 1);
+	im_msg *m = im.msgs[slot];
+
+	return (m && m->token == token) ? m : NULL;
+}
+
+/* Release message and its slot, mutex must be held */
+static void im_free(im_msg *m)
+{
+	unsigned slot = m->token & (IM_MAX_MESSAGES - 1);
+	im_dest *d = m->dest;
+
+	im.msgs[slot] = NULL;
+	im.free_slots[im.free_cnt++] = slot;
+	pj_pool_release(m->pool);
+
+	if (--d->msg_cnt == 0) {
+		im_dest_idle(d);
+		im_schedule(IM_PUMP_MSEC);
+	}
+}
+
+static int im_queue(int acc_id, int call_id, const char *key, const char *message)
+{
+	pj_pool_t *pool;
+	im_msg *m;
+	unsigned slot;
+	pj_size_t len;
+
+	if (im.mutex == NULL || message == NULL)
+		return -1;
+
+	len = pj_ansi_strlen(message);
+	pool = pjsua_pool_create("im", 256 + len, 256);
+	m = PJ_POOL_ZALLOC_T(pool, im_msg);
+	m->pool = pool;
+	m->acc_id = acc_id;
+	m->call_id = call_id;
+	pj_strdup2(pool, &m->body, message);
+
+	pj_mutex_lock(im.mutex);
+	if (im.free_cnt == 0) {
+		pj_mutex_unlock(im.mutex);
+		pj_pool_release(pool);
+		PJ_LOG(2,(THIS_FILE, "Message queue is full"));
+		return -1;
+	}
+
+	slot = im.free_slots[--im.free_cnt];
+	if (++im.seq >= (1u << (31 - IM_SLOT_BITS)))
+		im.seq = 1;
+	m->token = (int)((im.seq << IM_SLOT_BITS) | slot);
+	im.msgs[slot] = m;
+
+	m->dest = im_get_dest(key);
+	++m->dest->msg_cnt;
+	pj_list_push_back(&m->dest->pending, m);
+	im_dest_ready(m->dest);
+	im_schedule(0);
+	pj_mutex_unlock(im.mutex);
+
+	return m->token;
+}
+
+static void im_report(int token, int code)
+{
+	if (cb_messagestatus != 0)
+		(*cb_messagestatus)(token, code);
+}
+
+/* Send MESSAGE, must be called without mutex held */
+static pj_status_t im_send(im_msg *m)
+{
+	void *user_data = (void*)(pj_ssize_t) m->token;
+
+	if (m->call_id != PJSUA_INVALID_ID)
+		return pjsua_call_send_im(m->call_id, NULL, &m->body, NULL, user_data);
+
+	return pjsua_im_send(m->acc_id, &m->dest->uri, NULL, &m->body, NULL, user_data);
+}
+
+/* Add send credit for the time since last pump and return number of
+ * messages that may be sent now. Burst is limited to one pump period,
+ * but at least one message. Mutex must be held
+ */
+static unsigned im_take_budget(const pj_time_val *now)
+{
+	pj_time_val elapsed = *now;
+	unsigned msec, max_credit;
+
+	if (im_cfg.max_per_second == 0 ||
+	    im_cfg.max_per_second >= IM_MAX_BATCH * 1000 / IM_PUMP_MSEC)
+	{
+		return IM_MAX_BATCH;
+	}
+
+	PJ_TIME_VAL_SUB(elapsed, im.last_pump);
+	msec = (elapsed.sec >= 1) ? 1000 : elapsed.msec;
+	im.last_pump = *now;
+
+	max_credit = PJ_MAX(1000, im_cfg.max_per_second * IM_PUMP_MSEC);
+	im.credit += msec * im_cfg.max_per_second;
+	if (im.credit > max_credit)
+		im.credit = max_credit;
+
+	return im.credit / 1000;
+}
+
+/* Send messages whose destination may send now, runs in pjsip worker */
+static void im_pump(pj_timer_heap_t *timer_heap, struct pj_timer_entry *entry)
+{
+	im_msg *batch[IM_MAX_BATCH];
+	unsigned count = 0, budget, i;
+	pj_time_val now;
+	im_dest *d, *next;
+
+	PJ_UNUSED_ARG(timer_heap);
+	PJ_UNUSED_ARG(entry);
+
+	pj_gettickcount(&now);
+
+	pj_mutex_lock(im.mutex);
+	im.scheduled = PJ_FALSE;
+	budget = im_take_budget(&now);
+
+	for (d = im.ready.next; d != &im.ready && count < budget; d = next) {
+		im_msg *m;
+
+		next = d->next;
+
+		if (pj_list_empty(&d->pending)) {
+			pj_list_erase(d);
+			d->ready = PJ_FALSE;
+			continue;
+		}
+
+		m = d->pending.next;
+		if (PJ_TIME_VAL_LT(now, d->next_send) || PJ_TIME_VAL_LT(now, m->not_before))
+			continue;
+
+		pj_list_erase(m);
+		m->in_flight = PJ_TRUE;
+		batch[count++] = m;
+
+		d->next_send = now;
+		time_add_msec(&d->next_send, im_cfg.dest_interval);
+
+		// round robin, destination goes to the end of ready list
+		pj_list_erase(d);
+		if (pj_list_empty(&d->pending)) {
+			d->ready = PJ_FALSE;
+		} else {
+			pj_list_push_back(&im.ready, d);
+		}
+	}
+
+	if (im.credit >= count * 1000)
+		im.credit -= count * 1000;
+	else
+		im.credit = 0;
+
+	im_dest_sweep(&now);
+
+	if (!pj_list_empty(&im.ready) || !pj_list_empty(&im.idle))
+		im_schedule(IM_PUMP_MSEC);
+	pj_mutex_unlock(im.mutex);
+
+	for (i=0; i<count; ++i) {
+		int token = batch[i]->token;
+		pj_status_t status = im_send(batch[i]);
+
+		// message may be gone already if status was reported synchronously
+		if (status != PJ_SUCCESS) {
+			pjsua_perror(THIS_FILE, "Unable to send queued message", status);
+			im_on_pager_status((void*)(pj_ssize_t) token, PJSIP_SC_SERVICE_UNAVAILABLE);
+		}
+	}
+}
+
+/* Final status of queued MESSAGE. 408 and 503 are retried with backoff,
+ * other codes are reported.
+ */
+void im_on_pager_status(void *userData, int code)
+{
+	int token = (int)(pj_ssize_t) userData;
+	im_msg *m;
+
+	if (token <= 0 || im.mutex == NULL)
+		return;
+
+	pj_mutex_lock(im.mutex);
+	m = im_find(token);
+	if (m == NULL || !m->in_flight) {
+		pj_mutex_unlock(im.mutex);
+		return;
+	}
+
+	if ((code == PJSIP_SC_REQUEST_TIMEOUT || code == PJSIP_SC_SERVICE_UNAVAILABLE) &&
+	    m->retries < im_cfg.max_retries)
+	{
+		m->in_flight = PJ_FALSE;
+		pj_gettickcount(&m->not_before);
+		time_add_msec(&m->not_before, im_cfg.retry_delay << m->retries);
+		++m->retries;
+
+		pj_list_push_front(&m->dest->pending, m);
+		im_dest_ready(m->dest);
+		im_schedule(IM_PUMP_MSEC);
+		pj_mutex_unlock(im.mutex);
+		return;
+	}
+
+	im_free(m);
+	pj_mutex_unlock(im.mutex);
+
+	im_report(token, code);
+}
+
+
+//////////////////////////////////////////////////////////////////////////
+// Typing indications
+
+static void typing_report(typing_peer *p, pj_bool_t is_typing)
+{
+	if (cb_typing != 0)
+		(*cb_typing)(p->call_id, p->uri.ptr, is_typing);
+}
+
+/* Send indication, must be called without mutex held */
+static void typing_send(typing_peer *p, pj_bool_t is_typing)
+{
+	pj_status_t status;
+
+	status = pjsua_im_typing(p->acc_id, &p->uri, is_typing, NULL);
+	if (status != PJ_SUCCESS)
+		pjsua_perror(THIS_FILE, "Unable to send typing indication", status);
+}
+
+/* Free peers whose state didn't change for TYPING_EXPIRE, except peer
+ * in use by the caller. Peers are used without mutex only right after
+ * their state changed. Mutex must be held
+ */
+static void typing_expire(typing_peer *in_use)
+{
+	typing_peer *p, *next;
+	pj_time_val expire;
+
+	pj_gettickcount(&expire);
+	expire.sec -= TYPING_EXPIRE;
+
+	for (p = im.peers.next; p != &im.peers; p = next) {
+		next = p->next;
+
+		if (p == in_use || p->idle_pending || !PJ_TIME_VAL_LT(p->last, expire))
+			continue;
+
+		pj_list_erase(p);
+		pj_hash_set(NULL, im.typing, p->key.ptr, (unsigned)p->key.slen, 0, NULL);
+		pj_pool_release(p->pool);
+	}
+}
+
+/* Delayed idle, runs in pjsip worker */
+static void typing_timer_cb(pj_timer_heap_t *timer_heap, struct pj_timer_entry *entry)
+{
+	typing_peer *p = (typing_peer*) entry->user_data;
+	pj_bool_t idle;
+
+	PJ_UNUSED_ARG(timer_heap);
+
+	pj_mutex_lock(im.mutex);
+	idle = p->idle_pending && p->active;
+	p->idle_pending = PJ_FALSE;
+	if (idle) {
+		p->active = PJ_FALSE;
+		pj_gettickcount(&p->last);
+	}
+	typing_expire(p);
+	pj_mutex_unlock(im.mutex);
+
+	if (!idle)
+		return;
+
+	if (p->outgoing)
+		typing_send(p, PJ_FALSE);
+	else
+		typing_report(p, PJ_FALSE);
+}
+
+/* Find or create peer, mutex must be held */
+static typing_peer* typing_get_peer(const char *key, unsigned key_len, const char *uri,
+				    unsigned uri_len, pj_bool_t outgoing)
+{
+	pj_pool_t *pool;
+	typing_peer *p;
+	pj_str_t tmp;
+
+	p = (typing_peer*) pj_hash_get(im.typing, key, key_len, NULL);
+	if (p)
+		return p;
+
+	typing_expire(NULL);
+
+	pool = pjsua_pool_create("typing", 256 + key_len + uri_len, 256);
+	p = PJ_POOL_ZALLOC_T(pool, typing_peer);
+	p->pool = pool;
+	tmp.ptr = (char*) key;
+	tmp.slen = key_len;
+	pj_strdup(pool, &p->key, &tmp);
+	tmp.ptr = (char*) uri;
+	tmp.slen = uri_len;
+	pj_strdup_with_null(pool, &p->uri, &tmp);
+	p->outgoing = outgoing;
+	p->call_id = PJSUA_INVALID_ID;
+	pj_gettickcount(&p->last);
+	pj_timer_entry_init(&p->timer, 0, p, &typing_timer_cb);
+	pj_list_push_back(&im.peers, p);
+	// hash entry is allocated from peer pool too
+	pj_hash_set(pool, im.typing, p->key.ptr, (unsigned)p->key.slen, 0, p);
+
+	return p;
+}
+
+/* Apply new state of peer, mutex must be held. Returns PJ_TRUE when
+ * "typing" has to be passed on now, idle is delayed by typing window.
+ */
+static pj_bool_t typing_update(typing_peer *p, pj_bool_t is_typing)
+{
+	pj_time_val now, refresh;
+
+	if (!is_typing) {
+		if (p->active && !p->idle_pending) {
+			pj_time_val delay = {0, 0};
+
+			delay.msec = im_cfg.typing_window;
+			PJ_TIME_VAL_NORMALIZE(delay);
+			if (pjsip_endpt_schedule_timer(pjsua_get_pjsip_endpt(), &p->timer,
+						       &delay) == PJ_SUCCESS)
+			{
+				p->idle_pending = PJ_TRUE;
+			}
+		}
+		return PJ_FALSE;
+	}
+
+	// typing resumed within window, peer never sees the pause
+	if (p->idle_pending) {
+		pjsip_endpt_cancel_timer(pjsua_get_pjsip_endpt(), &p->timer);
+		p->idle_pending = PJ_FALSE;
+	}
+
+	pj_gettickcount(&now);
+	refresh = p->last;
+	refresh.sec += TYPING_REFRESH;
+	if (p->active && PJ_TIME_VAL_LT(now, refresh))
+		return PJ_FALSE;
+
+	p->active = PJ_TRUE;
+	p->last = now;
+	return PJ_TRUE;
+}
+
+/* Received typing indication, called from on_typing */
+void im_on_typing(int callId, const char *from, int fromLen, int isTyping)
+{
+	typing_peer *p;
+	pj_bool_t report;
+
+	if (im.mutex == NULL || from == NULL || fromLen <= 0)
+		return;
+
+	pj_mutex_lock(im.mutex);
+	p = typing_get_peer(from, fromLen, from, fromLen, PJ_FALSE);
+	p->call_id = callId;
+	report = typing_update(p, isTyping ? PJ_TRUE : PJ_FALSE);
+	pj_mutex_unlock(im.mutex);
+
+	if (report)
+		typing_report(p, PJ_TRUE);
+}
+
+
+//////////////////////////////////////////////////////////////////////////
+// Init/destroy
+
+int im_init(void)
+{
+	pj_status_t status;
+	unsigned i;
+
+	pj_bzero(&im, sizeof(im));
+
+	im.pool = pjsua_pool_create("imqueue", 4000, 4000);
+
+	status = pj_mutex_create_simple(im.pool, "imqueue", &im.mutex);
+	if (status != PJ_SUCCESS)
+		return status;
+
+	im.dests = pj_hash_create(im.pool, IM_HASH_SIZE);
+	pj_list_init(&im.ready);
+	pj_list_init(&im.idle);
+
+	// lowest slots are taken first
+	for (i=0; i<IM_MAX_MESSAGES; ++i)
+		im.free_slots[i] = IM_MAX_MESSAGES - 1 - i;
+	im.free_cnt = IM_MAX_MESSAGES;
+
+	pj_timer_entry_init(&im.timer, 0, NULL, &im_pump);
+
+	im.typing = pj_hash_create(im.pool, IM_HASH_SIZE);
+	pj_list_init(&im.peers);
+
+	return PJ_SUCCESS;
+}
+
+void im_destroy(void)
+{
+	typing_peer *p;
+	unsigned i;
+
+	if (im.pool == NULL)
+		return;
+
+	if (im.scheduled)
+		pjsip_endpt_cancel_timer(pjsua_get_pjsip_endpt(), &im.timer);
+
+	while (!pj_list_empty(&im.peers)) {
+		p = im.peers.next;
+		if (p->idle_pending)
+			pjsip_endpt_cancel_timer(pjsua_get_pjsip_endpt(), &p->timer);
+		pj_list_erase(p);
+		pj_pool_release(p->pool);
+	}
+
+	// messages still queued or in flight are dropped, status is not reported
+	for (i=0; i<IM_MAX_MESSAGES; ++i) {
+		im_dest *d;
+
+		if (im.msgs[i] == NULL)
+			continue;
+
+		d = im.msgs[i]->dest;
+		pj_pool_release(im.msgs[i]->pool);
+		if (--d->msg_cnt == 0)
+			pj_pool_release(d->pool);
+	}
+	while (!pj_list_empty(&im.idle)) {
+		im_dest *d = im.idle.next;
+
+		pj_list_erase(d);
+		pj_pool_release(d->pool);
+	}
+
+	if (im.mutex)
+		pj_mutex_destroy(im.mutex);
+	pj_pool_release(im.pool);
+	pj_bzero(&im, sizeof(im));
+}
+
+
+//////////////////////////////////////////////////////////////////////////
+// API
+
+int onMessageStatusCallback(fptr_messagestatus cb)
+{
+	cb_messagestatus = cb;
+	return 1;
+}
+
+int onTypingCallback(fptr_typing cb)
+{
+	cb_typing = cb;
+	return 1;
+}
+
+int dll_queueMessage(int accId, char* uri, char* message)
+{
+	if (uri == NULL || !pjsua_acc_is_valid(accId))
+		return -1;
+
+	return im_queue(accId, PJSUA_INVALID_ID, uri, message);
+}
+
+int dll_queueCallMessage(int callId, char* message)
+{
+	char key[32];
+
+	if (!pjsua_call_is_active(callId))
+		return -1;
+
+	// call messages are paced per call
+	pj_ansi_snprintf(key, sizeof(key), "call:%d", callId);
+	return im_queue(PJSUA_INVALID_ID, callId, key, message);
+}
+
+int dll_setMessageQueueConfig(int destIntervalMs, int maxPerSecond, int maxRetries, int retryDelayMs)
+{
+	if (destIntervalMs < 0 || maxPerSecond < 0 || maxRetries < 0 || retryDelayMs < 0)
+		return PJ_EINVAL;
+
+	im_cfg.dest_interval = destIntervalMs;
+	im_cfg.max_per_second = maxPerSecond;
+	im_cfg.max_retries = maxRetries > 8 ? 8 : maxRetries;
+	im_cfg.retry_delay = retryDelayMs;
+
+	return PJ_SUCCESS;
+}
+
+/* Send typing indication to uri, redundant states are suppressed and
+ * idle is delayed by the typing window.
+ */
+int dll_sendTyping(int accId, char* uri, bool isTyping)
+{
+	char key[TYPING_KEY_LEN];
+	typing_peer *p;
+	pj_bool_t send;
+	int len;
+
+	if (uri == NULL || im.mutex == NULL || !pjsua_acc_is_valid(accId))
+		return PJ_EINVAL;
+
+	len = pj_ansi_snprintf(key, sizeof(key), "%d:%s", accId, uri);
+	if (len < 0 || len >= (int)sizeof(key))
+		return PJ_ETOOBIG;
+
+	pj_mutex_lock(im.mutex);
+	p = typing_get_peer(key, len, uri, (unsigned)pj_ansi_strlen(uri), PJ_TRUE);
+	p->acc_id = accId;
+	send = typing_update(p, isTyping ? PJ_TRUE : PJ_FALSE);
+	pj_mutex_unlock(im.mutex);
+
+	if (send)
+		typing_send(p, PJ_TRUE);
+
+	return PJ_SUCCESS;
+}
+
+int dll_setTypingWindow(int windowMs)
+{
+	if (windowMs < 0)
+		return PJ_EINVAL;
+
+	im_cfg.typing_window = windowMs;
+	return PJ_SUCCESS;
+}
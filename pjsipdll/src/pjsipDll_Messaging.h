@@ -0,0 +1,54 @@
+/*
+ * Copyright (C) 2007 Sasa Coh <sasacoh@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+// pjsipDll_Messaging.h : Outbound instant message queue and typing indications
+//
+
+#ifdef LINUX
+	#define __stdcall
+	#define PJSIPDLL_DLL_API
+#else
+#ifdef PJSIPDLL_EXPORTS
+	#define PJSIPDLL_DLL_API __declspec(dllexport)
+#else
+	#define PJSIPDLL_DLL_API __declspec(dllimport)
+#endif
+#endif
+
+// calback function definitions
+typedef int __stdcall fptr_messagestatus(int token, int code);	// code is final SIP status of MESSAGE
+typedef int __stdcall fptr_typing(int callId, const char* from, int isTyping);	// callId -1 outside of calls
+
+// Callback registration
+extern "C" PJSIPDLL_DLL_API int onMessageStatusCallback(fptr_messagestatus cb); // register message delivery notifier
+extern "C" PJSIPDLL_DLL_API int onTypingCallback(fptr_typing cb); // register typing indication notifier
+
+// Message queue API, queue functions return token reported in onMessageStatusCallback or -1
+extern "C" PJSIPDLL_DLL_API int dll_queueMessage(int accId, char* uri, char* message);
+extern "C" PJSIPDLL_DLL_API int dll_queueCallMessage(int callId, char* message);
+extern "C" PJSIPDLL_DLL_API int dll_setMessageQueueConfig(int destIntervalMs, int maxPerSecond, int maxRetries, int retryDelayMs);
+
+// Typing indication API
+extern "C" PJSIPDLL_DLL_API int dll_sendTyping(int accId, char* uri, bool isTyping);
+extern "C" PJSIPDLL_DLL_API int dll_setTypingWindow(int windowMs);	// idle is delayed and coalesced within window
+
+// Internal hooks called by pjsipDll.cpp
+int im_init(void);
+void im_destroy(void);
+void im_on_pager_status(void *userData, int code);
+void im_on_typing(int callId, const char *from, int fromLen, int isTyping);
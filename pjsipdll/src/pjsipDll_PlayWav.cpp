@@ -1,164 +1,1396 @@
-/*
-* Copyright (C) 2007 Sasa Coh <sasacoh[at]gmail.com>
-*
-* Updated by Tanguy Floc'h <tanguy.floch[at]gmail.com>
-*
-* This program is free software; you can redistribute it and/or modify
-* it under the terms of the GNU General Public License as published by
-* the Free Software Foundation; either version 2 of the License, or
-* (at your option) any later version.
-*
-* This program is distributed in the hope that it will be useful,
-* but WITHOUT ANY WARRANTY; without even the implied warranty of
-* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
-* GNU General Public License for more details.
-*
-* You should have received a copy of the GNU General Public License
-* along with this program; if not, write to the Free Software
-* Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
-*
-* This code is based on pjsip from Benny Prijono <benny@prijono.org>
-*
-*/
-
-#include "pjsipDll_PlayWav.h"
-#include <pjsua-lib/pjsua.h>
-
-
-#define THIS_FILE      "pjsipDll_playWav.cpp"
-#define NO_LIMIT       (int)0x7FFFFFFF
-
-
-static fptr_wavplayerEnded* cb_wavplayerEnded = 0;
- 
-/* Data callback "wavplayerEof" */
-struct wavplayerEof_Data
-{
-       pjsua_player_id playerId;
-       pjsua_call_id callId;
-};
-
-
-PJSIPDLL_DLL_API int onWavPlayerEndedCallback(fptr_wavplayerEnded cb)
-{
-  cb_wavplayerEnded = cb;
-  return 1;
-}
-
-/************************************************************
-    C callback
-    Launch when the player has reached the end of wav file
-------------------------------------------------------------*/
-
-static PJ_DEF(pj_status_t) on_wavplayerEof_callback(pjmedia_port* media_port, void* args)
-{
-       pj_status_t status;
-       wavplayerEof_Data* WavePlayerData = ((wavplayerEof_Data*) args);
- 
-       // Read info from args
-       pjsua_call_id call_id = WavePlayerData->callId;
-       pjsua_player_id player_id = WavePlayerData->playerId;
- 
-       //Destroy the Wav Player
-       //status = pjsua_player_destroy(player_id);   // ! Problem if Destroying Here : cash at the end of callback, for most of wavs files
- 
-       // Free the memory allocated for the args
-       free(args);
- 
-       PJ_LOG(3,(THIS_FILE, "End of Wav File, media_port: %d", media_port));
-       // Invoke the Callback for C# managed code
-       if (cb_wavplayerEnded != 0)
-               (*cb_wavplayerEnded)(call_id, player_id);
-
-       if (status == PJ_SUCCESS)    // Player correctly Destroyed
-               return -1;                      // Don't return PJ_SUCCESS, to prevent crash when returning from callback after Player Destruction
-
-       return PJ_SUCCESS;             // Else, return PJ_SUCCESS
-
-}      //// -> goes back to the function wich has invoke the callback : fill_buffer() in pjmedia\src\pjmedia\wav_player.c
-       /////   CRASH HERE WITH MOST OF WAV FILES, if player has been destroyed above ////
-
-/************************************************************
-  Play the wav file "wavFile", in the call session "callId"
-------------------------------------------------------------*/
- 
-int dll_playWav(char* wavFile, int callId)
-{
-       pj_status_t status;
-
-       /* Infos Player */
-       pjsua_player_id player_id;            // Ident. for the player
-       pjmedia_port *media_port;           // Struct. media_port
-       pjsua_conf_port_id conf_port;       // Conference port for the player
- 
-       /* Infos Call Session */
-       pjsua_call_info call_info;
-
-       /********************************************
-       / 1- Check if Call exists and is active
-       ********************************************/
-
-       // Get call_info from callId
-       pjsua_call_get_info(callId, &call_info);
-
-       if (call_info.media_status != PJSUA_CALL_MEDIA_ACTIVE)
-               return -1;
-
-       /********************************************
-       / 2- Load the WAV File - Create the player
-       ********************************************/
-       status = pjsua_player_create(&pj_str(wavFile), PJMEDIA_FILE_NO_LOOP, &player_id);
-
-       /********************************************
-       / 3- Register the Callback C++ Function "on_wavplayerEof_callback"
-       ********************************************/
-
-       if (status == PJ_SUCCESS)
-       {
-               // Get media_port from player_id
-               status = pjsua_player_get_port(player_id, &media_port);
-       }
- 
-       if (status == PJ_SUCCESS)
-       {
-               // Prepare argument for Callback
-               wavplayerEof_Data* args = (wavplayerEof_Data*)malloc(sizeof(wavplayerEof_Data));
-               args->playerId = player_id;
-               args->callId = callId;     
-
-               // Register the Callback, launched when the End of the Wave File is reached
-               status = pjmedia_wav_player_set_eof_cb(media_port, args, &on_wavplayerEof_callback);
-       }
- 
-       /********************************************
-       / 4- Stream the file to the Call Session
-       ********************************************/
-
-       // Get conf_port from player_id
-       if (status == PJ_SUCCESS)
-               conf_port = pjsua_player_get_conf_port(player_id);
-
- 
-       // one way connect conf_port (wav player) to call_info.conf_slot (call)
-       if ((status == PJ_SUCCESS)&&(conf_port != PJSUA_INVALID_ID)&&(call_info.conf_slot != 0))        // test if conf_port valid, and if conf_slot != soundcard
-       {
-               status = pjsua_conf_connect(conf_port, call_info.conf_slot);
-       }
-
-       PJ_LOG(3,(THIS_FILE,"Wav Play, status %d",status));
-
-       if (status != PJ_SUCCESS)
-               return -1;
-
-       return player_id;
-}
-
-/************************************************************
-  To stop player, without waiting the end of wav file
-------------------------------------------------------------*/
-bool dll_releaseWav(int playerId)
-{
-       //Destroy the Wav Player
-       return (pjsua_player_destroy(playerId) == PJ_SUCCESS);
-}
-
+/*
+* Copyright (C) 2007 Sasa Coh <sasacoh[at]gmail.com>
+*
+* Updated by Tanguy Floc'h <tanguy.floch[at]gmail.com>
+*
+* This program is free software; you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation; either version 2 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program; if not, write to the Free Software
+* Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+*
+* This code is based on pjsip from Benny Prijono <benny@prijono.org>
+*
+*/
+
+#include "pjsipDll_PlayWav.h"
+#include <pjsua-lib/pjsua.h>
+
+#ifdef LINUX
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#else
+#include <windows.h>
+#endif
+
+
+#define THIS_FILE      "pjsipDll_playWav.cpp"
+#define NO_LIMIT       (int)0x7FFFFFFF
+
+#define MAX_PROMPTS            256
+#define MAX_PROMPT_PLAYERS     PJSUA_MAX_CONF_PORTS
+#define PROMPT_PLAYER_BASE     0x1000      // prompt player ids don't clash with pjsua player ids
+#define MAX_MAPPED_FILES       64
+#define MAX_SEQUENCE           64
+#define MAX_BARGEIN_DIGITS     16
+#define SIGNATURE              PJMEDIA_PORT_SIGNATURE('S', 'M', 'A', 'P')
+
+
+static fptr_wavplayerEnded* cb_wavplayerEnded = 0;
+static fptr_bargein* cb_bargein = 0;
+ 
+/* Data callback "wavplayerEof", one per pjsua player id */
+struct wavplayerEof_Data
+{
+       pjsua_player_id playerId;
+       pjsua_call_id callId;
+       pjsua_conf_port_id callSlot;
+       pj_bool_t active;               // guarded by wav.mutex
+       pj_bool_t eof;
+       pj_bool_t bargein;              // stop on DTMF, guarded by wav.mutex
+       char bargeinDigits[MAX_BARGEIN_DIGITS+1];
+};
+
+
+PJSIPDLL_DLL_API int onWavPlayerEndedCallback(fptr_wavplayerEnded cb)
+{
+  cb_wavplayerEnded = cb;
+  return 1;
+}
+
+PJSIPDLL_DLL_API int onBargeInCallback(fptr_bargein cb)
+{
+  cb_bargein = cb;
+  return 1;
+}
+
+/* Preloaded prompt. Samples are immutable and shared by all players,
+ * prompt is freed when it is released and its last player is gone.
+ */
+struct prompt_data
+{
+       pj_pool_t          *pool;
+       int                 id;
+       unsigned            refcnt;         // cache + players, guarded by wav.mutex
+       unsigned            clock_rate;
+       pj_int16_t         *samples;
+       pj_size_t           size;           // in bytes
+};
+
+/* Format and data of a WAV file */
+struct wav_info
+{
+       pj_uint16_t         tag;            // 1 PCM, 6 A-law, 7 u-law
+       unsigned            channels;
+       unsigned            block;          // bytes per sample frame
+       unsigned            clock_rate;
+       const pj_uint8_t   *data;
+       pj_uint32_t         count;          // number of sample frames
+};
+
+/* Memory mapped WAV file, shared by all players of the same path */
+struct mapped_file
+{
+       char                path[PJ_MAXPATH];
+       unsigned            refcnt;         // guarded by wav.mutex
+#ifdef LINUX
+       int                 fd;
+#else
+       HANDLE              file;
+       HANDLE              mapping;
+#endif
+       pj_uint8_t         *base;
+       pj_size_t           size;
+       wav_info            info;
+};
+
+struct prompt_player;
+
+/* Player of prompt sequence, next prompt continues in the same frame */
+struct sequence_port
+{
+       pjmedia_port        base;
+       prompt_player      *player;
+       unsigned            index;          // current prompt
+       pj_size_t           pos;            // sample in current prompt
+       pj_bool_t           eof;
+};
+
+/* Player reading samples directly from the mapping */
+struct mapped_port
+{
+       pjmedia_port        base;
+       mapped_file        *file;
+       pj_uint32_t         pos;
+       pj_bool_t           loop;
+       pj_bool_t           eof;
+       void               *eof_data;
+       pj_status_t       (*eof_cb)(pjmedia_port*, void*);
+};
+
+/* Memory player referencing prompt samples, prompt sequence player
+   or mapped file player */
+struct prompt_player
+{
+       pj_pool_t          *pool;
+       int                 id;
+       prompt_data        *prompt;
+       prompt_data       **seq;            // prompts of sequence player
+       unsigned            seq_cnt;
+       mapped_file        *file;
+       pjmedia_port       *port;
+       pjsua_conf_port_id  slot;
+       pjsua_call_id       call_id;
+       pj_bool_t           eof;
+       pj_bool_t           bargein;        // stop on DTMF, guarded by wav.mutex
+       char                bargein_digits[MAX_BARGEIN_DIGITS+1];
+};
+
+static struct wav_data
+{
+       pj_pool_t          *pool;
+       pj_mutex_t         *mutex;
+       prompt_data        *prompts[MAX_PROMPTS];
+       mapped_file        *files[MAX_MAPPED_FILES];
+       prompt_player      *players[MAX_PROMPT_PLAYERS];
+       // not part of player, timer may fire after player is gone
+       pj_timer_entry      player_timer[MAX_PROMPT_PLAYERS];
+
+       // music on hold, one looping source for all held calls
+       pj_pool_t          *moh_pool;
+       mapped_file        *moh_file;
+       pjmedia_port       *moh_port;
+       pjsua_conf_port_id  moh_slot;
+       pjsua_conf_port_id  moh_call_slot[PJSUA_MAX_CALLS];   // slot MOH is connected to
+
+       // players created by dll_playWav, reclaimed after EOF
+       wavplayerEof_Data   file_players[PJSUA_MAX_PLAYERS];
+       pj_timer_entry      file_player_timer[PJSUA_MAX_PLAYERS];
+
+       // called after a source is connected to call, without wav.mutex
+       void              (*on_call_source)(int callId);
+} wav;
+
+/************************************************************
+    Deferred player destruction
+    Runs in pjsip worker, after the EOF callback has returned
+    and the bridge doesn't use the player anymore
+------------------------------------------------------------*/
+
+static void wavplayer_timer_cb(pj_timer_heap_t *timer_heap, struct pj_timer_entry *entry)
+{
+       wavplayerEof_Data* data = &wav.file_players[entry->id];
+       pjsua_call_id call_id;
+       pjsua_player_id player_id;
+       pjsua_conf_port_id call_slot;
+       pj_bool_t finished;
+
+       PJ_UNUSED_ARG(timer_heap);
+
+       pj_mutex_lock(wav.mutex);
+       finished = data->active && data->eof;
+       if (finished)
+               data->active = PJ_FALSE;
+       call_id = data->callId;
+       player_id = data->playerId;
+       call_slot = data->callSlot;
+       pj_mutex_unlock(wav.mutex);
+
+       // player has been released by application
+       if (!finished)
+               return;
+
+       // disconnect from the call, then free player and its conference slot
+       pjsua_conf_disconnect(pjsua_player_get_conf_port(player_id), call_slot);
+       pjsua_player_destroy(player_id);
+
+       PJ_LOG(4,(THIS_FILE, "Wav player %d finished and destroyed", player_id));
+
+       // Invoke the Callback for C# managed code
+       if (cb_wavplayerEnded != 0)
+               (*cb_wavplayerEnded)(call_id, player_id);
+}
+
+/************************************************************
+    C callback
+    Launch when the player has reached the end of wav file
+------------------------------------------------------------*/
+
+static PJ_DEF(pj_status_t) on_wavplayerEof_callback(pjmedia_port* media_port, void* args)
+{
+       wavplayerEof_Data* data = ((wavplayerEof_Data*) args);
+       pj_time_val delay = {0, 0};
+
+       PJ_UNUSED_ARG(media_port);
+
+       // Player can't be destroyed here, wav_player.c still uses it
+       // when callback returns. Destroy it in the worker instead.
+       if (!data->eof) {
+               data->eof = PJ_TRUE;
+               pjsip_endpt_schedule_timer(pjsua_get_pjsip_endpt(),
+                                          &wav.file_player_timer[data->playerId], &delay);
+       }
+
+       return PJ_SUCCESS;
+}
+
+/************************************************************
+  Play the wav file "wavFile", in the call session "callId"
+------------------------------------------------------------*/
+ 
+int dll_playWav(char* wavFile, int callId)
+{
+       pj_status_t status;
+
+       /* Infos Player */
+       pjsua_player_id player_id = PJSUA_INVALID_ID;   // Ident. for the player
+       pjmedia_port *media_port;           // Struct. media_port
+       pjsua_conf_port_id conf_port;       // Conference port for the player
+ 
+       /* Infos Call Session */
+       pjsua_call_info call_info;
+
+       /********************************************
+       / 1- Check if Call exists and is active
+       ********************************************/
+
+       // Get call_info from callId
+       if (wav.mutex == NULL || pjsua_call_get_info(callId, &call_info) != PJ_SUCCESS)
+               return -1;
+
+       if (call_info.media_status != PJSUA_CALL_MEDIA_ACTIVE)
+               return -1;
+
+       /********************************************
+       / 2- Load the WAV File - Create the player
+       ********************************************/
+       status = pjsua_player_create(&pj_str(wavFile), PJMEDIA_FILE_NO_LOOP, &player_id);
+
+       /********************************************
+       / 3- Register the Callback C++ Function "on_wavplayerEof_callback"
+       ********************************************/
+
+       if (status == PJ_SUCCESS)
+       {
+               // Get media_port from player_id
+               status = pjsua_player_get_port(player_id, &media_port);
+       }
+ 
+       if (status == PJ_SUCCESS)
+       {
+               // Prepare argument for Callback, no allocation per player
+               wavplayerEof_Data* args = &wav.file_players[player_id];
+
+               pj_mutex_lock(wav.mutex);
+               args->playerId = player_id;
+               args->callId = callId;
+               args->callSlot = call_info.conf_slot;
+               args->eof = PJ_FALSE;
+               args->active = PJ_TRUE;
+               args->bargein = PJ_FALSE;
+               pj_mutex_unlock(wav.mutex);
+
+               // Register the Callback, launched when the End of the Wave File is reached
+               status = pjmedia_wav_player_set_eof_cb(media_port, args, &on_wavplayerEof_callback);
+       }
+ 
+       /********************************************
+       / 4- Stream the file to the Call Session
+       ********************************************/
+
+       // Get conf_port from player_id
+       if (status == PJ_SUCCESS)
+               conf_port = pjsua_player_get_conf_port(player_id);
+
+ 
+       // one way connect conf_port (wav player) to call_info.conf_slot (call)
+       if ((status == PJ_SUCCESS)&&(conf_port != PJSUA_INVALID_ID)&&(call_info.conf_slot != 0))        // test if conf_port valid, and if conf_slot != soundcard
+       {
+               status = pjsua_conf_connect(conf_port, call_info.conf_slot);
+               if (status == PJ_SUCCESS && wav.on_call_source)
+                       (*wav.on_call_source)(callId);
+       }
+
+       PJ_LOG(3,(THIS_FILE,"Wav Play, status %d",status));
+
+       if (status != PJ_SUCCESS)
+       {
+               // player may fail before it is marked active, destroy it here
+               if (player_id != PJSUA_INVALID_ID) {
+                       pj_mutex_lock(wav.mutex);
+                       wav.file_players[player_id].active = PJ_FALSE;
+                       pj_mutex_unlock(wav.mutex);
+                       pjsua_player_destroy(player_id);
+               }
+               return -1;
+       }
+
+       return player_id;
+}
+
+/************************************************************
+  To stop player, without waiting the end of wav file
+------------------------------------------------------------*/
+bool dll_releaseWav(int playerId)
+{
+       pj_bool_t active;
+
+       if (playerId >= PROMPT_PLAYER_BASE)
+               return (dll_stopPrompt(playerId) == PJ_SUCCESS);
+
+       if (playerId < 0 || playerId >= PJSUA_MAX_PLAYERS || wav.mutex == NULL)
+               return false;
+
+       // Whoever clears active destroys the player, EOF timer may have
+       // finished it already
+       pj_mutex_lock(wav.mutex);
+       active = wav.file_players[playerId].active;
+       wav.file_players[playerId].active = PJ_FALSE;
+       pj_mutex_unlock(wav.mutex);
+
+       if (!active)
+               return false;
+
+       pjsip_endpt_cancel_timer(pjsua_get_pjsip_endpt(), &wav.file_player_timer[playerId]);
+
+       //Destroy the Wav Player
+       return (pjsua_player_destroy(playerId) == PJ_SUCCESS);
+}
+
+
+/************************************************************
+  Prompt cache
+------------------------------------------------------------*/
+
+static pj_uint16_t get16(const pj_uint8_t *p)
+{
+       return (pj_uint16_t)(p[0] | (p[1] << 8));
+}
+
+static pj_uint32_t get32(const pj_uint8_t *p)
+{
+       return get16(p) | ((pj_uint32_t)get16(p+2) << 16);
+}
+
+/* Find fmt and data chunks. Supports PCM16, u-law and A-law, mono
+   or stereo */
+static pj_status_t wav_parse(const pj_uint8_t *file, pj_size_t size, wav_info *info)
+{
+       const pj_uint8_t *p, *end;
+       pj_uint32_t data_len = 0;
+       unsigned bits = 0;
+
+       pj_bzero(info, sizeof(wav_info));
+
+       if (size < 12 || pj_memcmp(file, "RIFF", 4) || pj_memcmp(file+8, "WAVE", 4))
+               return PJ_EINVAL;
+
+       // walk the chunks, fmt must come before data
+       p = file + 12;
+       end = file + size;
+       while (p + 8 <= end) {
+               pj_uint32_t len = get32(p+4);
+
+               if (!pj_memcmp(p, "fmt ", 4) && len >= 16 && p + 8 + 16 <= end) {
+                       info->tag = get16(p+8);
+                       info->channels = get16(p+10);
+                       info->clock_rate = get32(p+12);
+                       bits = get16(p+22);
+               } else if (!pj_memcmp(p, "data", 4)) {
+                       info->data = p + 8;
+                       data_len = (pj_uint32_t)(end - info->data);
+                       if (len < data_len)
+                               data_len = len;
+                       break;
+               }
+               p += 8 + len + (len & 1);
+       }
+
+       if (info->data == NULL || info->channels < 1 || info->channels > 2 || info->clock_rate == 0 ||
+           !((info->tag == 1 && bits == 16) || ((info->tag == 6 || info->tag == 7) && bits == 8)))
+               return PJ_EINVAL;
+
+       info->block = info->channels * bits / 8;
+       info->count = data_len / info->block;
+       return PJ_SUCCESS;
+}
+
+/* Decode count sample frames starting at pos to 16-bit mono */
+static void wav_decode(const wav_info *info, pj_uint32_t pos, pj_int16_t *dst, unsigned count)
+{
+       const pj_uint8_t *s = info->data + pos * info->block;
+       unsigned i, ch;
+
+       if (info->tag == 1 && info->channels == 1) {
+               pj_memcpy(dst, s, count * sizeof(pj_int16_t));
+               return;
+       }
+
+       for (i=0; i<count; ++i) {
+               int sample = 0;
+
+               for (ch=0; ch<info->channels; ++ch, s += info->block / info->channels) {
+                       if (info->tag == 7)
+                               sample += pjmedia_ulaw2linear(*s);
+                       else if (info->tag == 6)
+                               sample += pjmedia_alaw2linear(*s);
+                       else
+                               sample += (pj_int16_t)get16(s);
+               }
+               dst[i] = (pj_int16_t)(sample / (int)info->channels);
+       }
+}
+
+/* Decode WAV file to 16-bit mono samples, stereo files are mixed
+   down to mono */
+static pj_status_t prompt_decode(prompt_data *prompt, const char *path)
+{
+       pj_pool_t *tmp;
+       pj_oshandle_t fd;
+       pj_uint8_t *file;
+       wav_info info;
+       pj_ssize_t size;
+       pj_status_t status;
+
+       size = (pj_ssize_t)pj_file_size(path);
+       if (size < 12)
+               return PJ_EINVAL;
+
+       // file is read once into temporary pool
+       tmp = pjsua_pool_create("promptfile", size + 1000, 1000);
+       file = (pj_uint8_t*) pj_pool_alloc(tmp, size);
+
+       status = pj_file_open(tmp, path, PJ_O_RDONLY, &fd);
+       if (status == PJ_SUCCESS) {
+               status = pj_file_read(fd, file, &size);
+               pj_file_close(fd);
+       }
+       if (status == PJ_SUCCESS)
+               status = wav_parse(file, size, &info);
+       if (status != PJ_SUCCESS) {
+               PJ_LOG(2,(THIS_FILE, "Unsupported WAV file %s", path));
+               pj_pool_release(tmp);
+               return status;
+       }
+
+       prompt->clock_rate = info.clock_rate;
+       prompt->size = info.count * sizeof(pj_int16_t);
+       prompt->samples = (pj_int16_t*) pj_pool_alloc(prompt->pool, prompt->size);
+       wav_decode(&info, 0, prompt->samples, info.count);
+
+       pj_pool_release(tmp);
+       return PJ_SUCCESS;
+}
+
+
+/************************************************************
+  Mapped file registry
+------------------------------------------------------------*/
+
+static void file_unmap(mapped_file *file)
+{
+#ifdef LINUX
+       if (file->base)
+               munmap(file->base, file->size);
+       if (file->fd >= 0)
+               close(file->fd);
+#else
+       if (file->base)
+               UnmapViewOfFile(file->base);
+       if (file->mapping)
+               CloseHandle(file->mapping);
+       if (file->file != INVALID_HANDLE_VALUE)
+               CloseHandle(file->file);
+#endif
+       free(file);
+}
+
+static pj_status_t file_map(const char *path, mapped_file **p_file)
+{
+       mapped_file *file = (mapped_file*) calloc(1, sizeof(mapped_file));
+       pj_status_t status;
+
+       if (file == NULL)
+               return PJ_ENOMEM;
+       pj_ansi_strncpy(file->path, path, sizeof(file->path) - 1);
+
+#ifdef LINUX
+       struct stat st;
+
+       file->fd = open(path, O_RDONLY);
+       if (file->fd < 0 || fstat(file->fd, &st) != 0) {
+               file_unmap(file);
+               return PJ_ENOTFOUND;
+       }
+       file->size = st.st_size;
+       file->base = (pj_uint8_t*) mmap(NULL, file->size, PROT_READ, MAP_SHARED, file->fd, 0);
+       if (file->base == MAP_FAILED) {
+               file->base = NULL;
+               file_unmap(file);
+               return PJ_ENOMEM;
+       }
+#else
+       file->file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING,
+                                FILE_ATTRIBUTE_NORMAL, NULL);
+       if (file->file == INVALID_HANDLE_VALUE) {
+               file_unmap(file);
+               return PJ_ENOTFOUND;
+       }
+       file->size = GetFileSize(file->file, NULL);
+       file->mapping = CreateFileMapping(file->file, NULL, PAGE_READONLY, 0, 0, NULL);
+       if (file->mapping)
+               file->base = (pj_uint8_t*) MapViewOfFile(file->mapping, FILE_MAP_READ, 0, 0, 0);
+       if (file->base == NULL) {
+               file_unmap(file);
+               return PJ_ENOMEM;
+       }
+#endif
+
+       status = wav_parse(file->base, file->size, &file->info);
+       if (status != PJ_SUCCESS) {
+               PJ_LOG(2,(THIS_FILE, "Unsupported WAV file %s", path));
+               file_unmap(file);
+               return status;
+       }
+
+       *p_file = file;
+       return PJ_SUCCESS;
+}
+
+/* Get mapping of the path, file is mapped once for all players.
+   wav.mutex must be held */
+static mapped_file *file_ref(const char *path)
+{
+       mapped_file *file;
+       int i, free_index = -1;
+
+       for (i=0; i<MAX_MAPPED_FILES; ++i) {
+               if (wav.files[i] == NULL) {
+                       if (free_index < 0)
+                               free_index = i;
+               } else if (pj_ansi_strcmp(wav.files[i]->path, path) == 0) {
+                       ++wav.files[i]->refcnt;
+                       return wav.files[i];
+               }
+       }
+
+       if (free_index < 0 || file_map(path, &file) != PJ_SUCCESS)
+               return NULL;
+
+       file->refcnt = 1;
+       wav.files[free_index] = file;
+       return file;
+}
+
+/* wav.mutex must be held */
+static void file_unref(mapped_file *file)
+{
+       int i;
+
+       if (--file->refcnt > 0)
+               return;
+
+       for (i=0; i<MAX_MAPPED_FILES; ++i) {
+               if (wav.files[i] == file)
+                       wav.files[i] = NULL;
+       }
+       file_unmap(file);
+}
+
+static pj_status_t mapped_get_frame(pjmedia_port *this_port, pjmedia_frame *frame)
+{
+       mapped_port *mp = (mapped_port*) this_port;
+       const wav_info *info = &mp->file->info;
+       unsigned spf = this_port->info.samples_per_frame;
+       pj_int16_t *dst = (pj_int16_t*) frame->buf;
+       unsigned i = 0;
+
+       if (mp->eof) {
+               if (mp->eof_cb)
+                       (*mp->eof_cb)(this_port, mp->eof_data);
+               frame->type = PJMEDIA_FRAME_TYPE_NONE;
+               frame->size = 0;
+               return PJ_EEOF;
+       }
+
+       // no read buffer, samples are decoded straight from the mapping
+       while (i < spf) {
+               unsigned count;
+
+               if (mp->pos >= info->count) {
+                       if (!mp->loop || info->count == 0)
+                               break;
+                       mp->pos = 0;
+               }
+
+               count = info->count - mp->pos;
+               if (count > spf - i)
+                       count = spf - i;
+               wav_decode(info, mp->pos, dst + i, count);
+               mp->pos += count;
+               i += count;
+       }
+
+       if (i < spf) {
+               pj_bzero(dst + i, (spf - i) * sizeof(pj_int16_t));
+               mp->eof = PJ_TRUE;
+       }
+
+       frame->type = PJMEDIA_FRAME_TYPE_AUDIO;
+       frame->size = spf * sizeof(pj_int16_t);
+       return PJ_SUCCESS;
+}
+
+static pj_status_t mapped_port_create(pj_pool_t *pool, mapped_file *file, unsigned ptime,
+                                      pj_bool_t loop, pjmedia_port **p_port)
+{
+       mapped_port *mp = PJ_POOL_ZALLOC_T(pool, mapped_port);
+       pj_str_t name = pj_str("mapped-wav");
+
+       pjmedia_port_info_init(&mp->base.info, &name, SIGNATURE, file->info.clock_rate,
+                              1, 16, file->info.clock_rate * ptime / 1000);
+       mp->base.get_frame = &mapped_get_frame;
+       mp->file = file;
+       mp->loop = loop;
+
+       *p_port = &mp->base;
+       return PJ_SUCCESS;
+}
+
+/* wav.mutex must be held */
+static void prompt_unref(prompt_data *prompt)
+{
+       if (--prompt->refcnt == 0)
+               pj_pool_release(prompt->pool);
+}
+
+static void prompt_player_destroy(prompt_player *player)
+{
+       // port is not called by the bridge after it is removed
+       if (player->slot != PJSUA_INVALID_ID)
+               pjsua_conf_remove_port(player->slot);
+       if (player->port)
+               pjmedia_port_destroy(player->port);
+
+       pj_mutex_lock(wav.mutex);
+       if (player->prompt)
+               prompt_unref(player->prompt);
+       while (player->seq_cnt > 0)
+               prompt_unref(player->seq[--player->seq_cnt]);
+       if (player->file)
+               file_unref(player->file);
+       pj_mutex_unlock(wav.mutex);
+
+       pj_pool_release(player->pool);
+}
+
+/* Runs in pjsip worker, after the EOF callback has returned */
+static void prompt_player_timer_cb(pj_timer_heap_t *timer_heap, struct pj_timer_entry *entry)
+{
+       int index = entry->id;
+       prompt_player *player;
+       pjsua_call_id call_id = PJSUA_INVALID_ID;
+       int player_id = -1;
+
+       PJ_UNUSED_ARG(timer_heap);
+
+       pj_mutex_lock(wav.mutex);
+       player = wav.players[index];
+       if (player && player->eof)
+               wav.players[index] = NULL;
+       else
+               player = NULL;
+       pj_mutex_unlock(wav.mutex);
+
+       if (player == NULL)
+               return;
+
+       call_id = player->call_id;
+       player_id = player->id;
+       prompt_player_destroy(player);
+
+       if (cb_wavplayerEnded != 0)
+               (*cb_wavplayerEnded)(call_id, player_id);
+}
+
+/* Called from the media thread for every frame after EOF */
+static pj_status_t on_prompt_eof(pjmedia_port* media_port, void* args)
+{
+       prompt_player* player = (prompt_player*) args;
+       int index = player->id - PROMPT_PLAYER_BASE;
+       pj_time_val delay = {0, 0};
+
+       PJ_UNUSED_ARG(media_port);
+
+       if (!player->eof) {
+               player->eof = PJ_TRUE;
+               pjsip_endpt_schedule_timer(pjsua_get_pjsip_endpt(), &wav.player_timer[index], &delay);
+       }
+
+       return PJ_SUCCESS;
+}
+
+int wav_init(void (*on_call_source)(int callId))
+{
+       unsigned i;
+
+       pj_bzero(&wav, sizeof(wav));
+       wav.on_call_source = on_call_source;
+
+       wav.pool = pjsua_pool_create("wav", 1000, 1000);
+       for (i=0; i<MAX_PROMPT_PLAYERS; ++i)
+               pj_timer_entry_init(&wav.player_timer[i], i, NULL, &prompt_player_timer_cb);
+
+       for (i=0; i<PJSUA_MAX_PLAYERS; ++i)
+               pj_timer_entry_init(&wav.file_player_timer[i], i, NULL, &wavplayer_timer_cb);
+
+       wav.moh_slot = PJSUA_INVALID_ID;
+       for (i=0; i<PJSUA_MAX_CALLS; ++i)
+               wav.moh_call_slot[i] = PJSUA_INVALID_ID;
+
+       return pj_mutex_create_simple(wav.pool, "wav", &wav.mutex);
+}
+
+void wav_destroy(void)
+{
+       unsigned i;
+
+       if (wav.pool == NULL)
+               return;
+
+       for (i=0; i<MAX_PROMPT_PLAYERS; ++i) {
+               pjsip_endpt_cancel_timer(pjsua_get_pjsip_endpt(), &wav.player_timer[i]);
+               if (wav.players[i])
+                       dll_stopPrompt(PROMPT_PLAYER_BASE + i);
+       }
+       for (i=0; i<MAX_PROMPTS; ++i) {
+               if (wav.prompts[i])
+                       dll_releasePrompt(i);
+       }
+
+       dll_setHoldMusic(NULL);
+
+       for (i=0; i<PJSUA_MAX_PLAYERS; ++i) {
+               if (wav.file_players[i].active)
+                       dll_releaseWav(i);
+       }
+
+       if (wav.mutex)
+               pj_mutex_destroy(wav.mutex);
+       pj_pool_release(wav.pool);
+       pj_bzero(&wav, sizeof(wav));
+}
+
+/************************************************************
+  Decode the wav file once into memory, returns prompt id
+------------------------------------------------------------*/
+int dll_preloadWav(char* waveFile)
+{
+       prompt_data *prompt;
+       pj_pool_t *pool;
+       int i;
+       pj_status_t status;
+
+       if (waveFile == NULL || wav.mutex == NULL)
+               return -1;
+
+       pool = pjsua_pool_create("prompt", 512, 512);
+       prompt = PJ_POOL_ZALLOC_T(pool, prompt_data);
+       prompt->pool = pool;
+       prompt->refcnt = 1;
+
+       status = prompt_decode(prompt, waveFile);
+       if (status != PJ_SUCCESS) {
+               pjsua_perror(THIS_FILE, "Unable to preload wav file", status);
+               pj_pool_release(pool);
+               return -1;
+       }
+
+       pj_mutex_lock(wav.mutex);
+       for (i=0; i<MAX_PROMPTS; ++i) {
+               if (wav.prompts[i] == NULL) {
+                       prompt->id = i;
+                       wav.prompts[i] = prompt;
+                       break;
+               }
+       }
+       pj_mutex_unlock(wav.mutex);
+
+       if (i == MAX_PROMPTS) {
+               pj_pool_release(pool);
+               return -1;
+       }
+
+       PJ_LOG(4,(THIS_FILE, "Prompt %d preloaded from %s, %d bytes", i, waveFile, (int)prompt->size));
+       return i;
+}
+
+/************************************************************
+  Remove prompt from cache, players keep their reference
+------------------------------------------------------------*/
+int dll_releasePrompt(int promptId)
+{
+       prompt_data *prompt;
+
+       if (promptId < 0 || promptId >= MAX_PROMPTS || wav.mutex == NULL)
+               return PJ_EINVAL;
+
+       pj_mutex_lock(wav.mutex);
+       prompt = wav.prompts[promptId];
+       wav.prompts[promptId] = NULL;
+       if (prompt)
+               prompt_unref(prompt);
+       pj_mutex_unlock(wav.mutex);
+
+       return prompt ? PJ_SUCCESS : PJ_ENOTFOUND;
+}
+
+/* Create player and reserve its id. Returns bridge ptime and call slot */
+static prompt_player *player_create(int callId, unsigned *ptime, pjsua_conf_port_id *call_slot)
+{
+       pjsua_call_info call_info;
+       pjsua_conf_port_info master;
+       prompt_player *player;
+       pj_pool_t *pool;
+       int i;
+
+       if (wav.mutex == NULL)
+               return NULL;
+
+       if (pjsua_call_get_info(callId, &call_info) != PJ_SUCCESS ||
+           call_info.media_status != PJSUA_CALL_MEDIA_ACTIVE)
+               return NULL;
+
+       // player frames must have the bridge ptime
+       if (pjsua_conf_get_port_info(0, &master) != PJ_SUCCESS)
+               return NULL;
+       *ptime = master.samples_per_frame * 1000 / master.channel_count / master.clock_rate;
+       *call_slot = call_info.conf_slot;
+
+       pool = pjsua_pool_create("promptplayer", 512, 512);
+       player = PJ_POOL_ZALLOC_T(pool, prompt_player);
+       player->pool = pool;
+       player->call_id = callId;
+       player->slot = PJSUA_INVALID_ID;
+
+       pj_mutex_lock(wav.mutex);
+       for (i=0; i<MAX_PROMPT_PLAYERS; ++i) {
+               if (wav.players[i] == NULL) {
+                       player->id = PROMPT_PLAYER_BASE + i;
+                       wav.players[i] = player;
+                       break;
+               }
+       }
+       pj_mutex_unlock(wav.mutex);
+
+       if (i == MAX_PROMPT_PLAYERS) {
+               pj_pool_release(pool);
+               return NULL;
+       }
+       return player;
+}
+
+/* Put player port to bridge and stream it to the call */
+static int player_start(prompt_player *player, pjsua_conf_port_id call_slot)
+{
+       pj_status_t status;
+
+       status = pjsua_conf_add_port(player->pool, player->port, &player->slot);
+       if (status == PJ_SUCCESS && call_slot != 0)
+               status = pjsua_conf_connect(player->slot, call_slot);
+
+       if (status != PJ_SUCCESS) {
+               pjsua_perror(THIS_FILE, "Unable to start player", status);
+               dll_stopPrompt(player->id);
+               return -1;
+       }
+
+       if (call_slot != 0 && wav.on_call_source)
+               (*wav.on_call_source)(player->call_id);
+
+       return player->id;
+}
+
+/************************************************************
+  Play preloaded prompt in the call session "callId"
+------------------------------------------------------------*/
+int dll_playPrompt(int promptId, int callId)
+{
+       prompt_player *player;
+       prompt_data *prompt;
+       pjsua_conf_port_id call_slot;
+       unsigned ptime;
+       pj_status_t status;
+
+       if (promptId < 0 || promptId >= MAX_PROMPTS)
+               return -1;
+
+       player = player_create(callId, &ptime, &call_slot);
+       if (player == NULL)
+               return -1;
+
+       // take prompt reference
+       pj_mutex_lock(wav.mutex);
+       prompt = wav.prompts[promptId];
+       if (prompt) {
+               player->prompt = prompt;
+               ++prompt->refcnt;
+       }
+       pj_mutex_unlock(wav.mutex);
+
+       if (prompt == NULL) {
+               dll_stopPrompt(player->id);
+               return -1;
+       }
+
+       status = pjmedia_mem_player_create(player->pool, prompt->samples, prompt->size,
+                                          prompt->clock_rate, 1, prompt->clock_rate * ptime / 1000, 16,
+                                          PJMEDIA_MEM_NO_LOOP, &player->port);
+       if (status == PJ_SUCCESS)
+               status = pjmedia_mem_player_set_eof_cb(player->port, player, &on_prompt_eof);
+       if (status != PJ_SUCCESS) {
+               pjsua_perror(THIS_FILE, "Unable to play prompt", status);
+               dll_stopPrompt(player->id);
+               return -1;
+       }
+
+       return player_start(player, call_slot);
+}
+
+static pj_status_t sequence_get_frame(pjmedia_port *this_port, pjmedia_frame *frame)
+{
+       sequence_port *sp = (sequence_port*) this_port;
+       prompt_player *player = sp->player;
+       unsigned spf = this_port->info.samples_per_frame;
+       pj_int16_t *dst = (pj_int16_t*) frame->buf;
+       unsigned i = 0;
+
+       if (sp->eof) {
+               on_prompt_eof(this_port, player);
+               frame->type = PJMEDIA_FRAME_TYPE_NONE;
+               frame->size = 0;
+               return PJ_EEOF;
+       }
+
+       while (i < spf && sp->index < player->seq_cnt) {
+               const prompt_data *prompt = player->seq[sp->index];
+               pj_size_t count = prompt->size / sizeof(pj_int16_t) - sp->pos;
+
+               if (count > spf - i)
+                       count = spf - i;
+               pj_memcpy(dst + i, prompt->samples + sp->pos, count * sizeof(pj_int16_t));
+               sp->pos += count;
+               i += (unsigned)count;
+
+               if (sp->pos * sizeof(pj_int16_t) >= prompt->size) {
+                       ++sp->index;
+                       sp->pos = 0;
+               }
+       }
+
+       if (i < spf)
+               pj_bzero(dst + i, (spf - i) * sizeof(pj_int16_t));
+       if (sp->index == player->seq_cnt)
+               sp->eof = PJ_TRUE;
+
+       frame->type = PJMEDIA_FRAME_TYPE_AUDIO;
+       frame->size = spf * sizeof(pj_int16_t);
+       return PJ_SUCCESS;
+}
+
+/************************************************************
+  Play preloaded prompts one after another without gaps,
+  onWavPlayerEndedCallback is called once after the last one
+------------------------------------------------------------*/
+int dll_playSequence(int callId, const int* promptIds, int count)
+{
+       prompt_player *player;
+       sequence_port *sp;
+       pjsua_conf_port_id call_slot;
+       pj_str_t name = pj_str("prompt-seq");
+       unsigned ptime, clock_rate = 0;
+       int i;
+
+       if (promptIds == NULL || count <= 0 || count > MAX_SEQUENCE)
+               return -1;
+
+       player = player_create(callId, &ptime, &call_slot);
+       if (player == NULL)
+               return -1;
+
+       player->seq = (prompt_data**) pj_pool_zalloc(player->pool, count * sizeof(prompt_data*));
+
+       // take references of all prompts, they must have the same clock rate
+       pj_mutex_lock(wav.mutex);
+       for (i=0; i<count; ++i) {
+               prompt_data *prompt = NULL;
+
+               if (promptIds[i] >= 0 && promptIds[i] < MAX_PROMPTS)
+                       prompt = wav.prompts[promptIds[i]];
+               if (prompt == NULL || (clock_rate && prompt->clock_rate != clock_rate))
+                       break;
+
+               clock_rate = prompt->clock_rate;
+               ++prompt->refcnt;
+               player->seq[player->seq_cnt++] = prompt;
+       }
+       pj_mutex_unlock(wav.mutex);
+
+       if (i < count) {
+               PJ_LOG(2,(THIS_FILE, "Invalid prompt %d in sequence", promptIds[i]));
+               dll_stopPrompt(player->id);
+               return -1;
+       }
+
+       sp = PJ_POOL_ZALLOC_T(player->pool, sequence_port);
+       pjmedia_port_info_init(&sp->base.info, &name, SIGNATURE, clock_rate,
+                              1, 16, clock_rate * ptime / 1000);
+       sp->base.get_frame = &sequence_get_frame;
+       sp->player = player;
+       player->port = &sp->base;
+
+       return player_start(player, call_slot);
+}
+
+/************************************************************
+  Play the wav file through shared memory mapping, for long
+  announcements and hold music played to many calls
+------------------------------------------------------------*/
+int dll_playWavMapped(char* waveFile, int callId, bool loop)
+{
+       prompt_player *player;
+       mapped_port *mp;
+       pjsua_conf_port_id call_slot;
+       unsigned ptime;
+
+       if (waveFile == NULL)
+               return -1;
+
+       player = player_create(callId, &ptime, &call_slot);
+       if (player == NULL)
+               return -1;
+
+       pj_mutex_lock(wav.mutex);
+       player->file = file_ref(waveFile);
+       pj_mutex_unlock(wav.mutex);
+
+       if (player->file == NULL) {
+               PJ_LOG(2,(THIS_FILE, "Unable to map wav file %s", waveFile));
+               dll_stopPrompt(player->id);
+               return -1;
+       }
+
+       mapped_port_create(player->pool, player->file, ptime, loop ? PJ_TRUE : PJ_FALSE, &player->port);
+       mp = (mapped_port*) player->port;
+       mp->eof_cb = &on_prompt_eof;
+       mp->eof_data = player;
+
+       return player_start(player, call_slot);
+}
+
+/************************************************************
+  Stop prompt player before the end of prompt
+------------------------------------------------------------*/
+int dll_stopPrompt(int playerId)
+{
+       int index = playerId - PROMPT_PLAYER_BASE;
+       prompt_player *player;
+
+       if (index < 0 || index >= MAX_PROMPT_PLAYERS || wav.mutex == NULL)
+               return PJ_EINVAL;
+
+       pj_mutex_lock(wav.mutex);
+       player = wav.players[index];
+       if (player) {
+               // EOF may have scheduled the timer, the slot can be reused
+               // only when the entry is free. Marking EOF stops the media
+               // thread from scheduling it again.
+               player->eof = PJ_TRUE;
+               pjsip_endpt_cancel_timer(pjsua_get_pjsip_endpt(), &wav.player_timer[index]);
+               wav.players[index] = NULL;
+       }
+       pj_mutex_unlock(wav.mutex);
+
+       if (player == NULL)
+               return PJ_ENOTFOUND;
+
+       prompt_player_destroy(player);
+
+       return PJ_SUCCESS;
+}
+
+
+/************************************************************
+  Music on hold
+------------------------------------------------------------*/
+
+/* Music on hold state is guarded by wav.mutex. Bridge calls don't take
+   pjsua lock and are made with the mutex held, call info is read before
+   the mutex is taken. */
+
+static pj_bool_t moh_connect(int callId, pjsua_conf_port_id call_slot)
+{
+       if (wav.moh_slot == PJSUA_INVALID_ID || wav.moh_call_slot[callId] == call_slot)
+               return PJ_FALSE;
+
+       if (pjsua_conf_connect(wav.moh_slot, call_slot) != PJ_SUCCESS)
+               return PJ_FALSE;
+
+       wav.moh_call_slot[callId] = call_slot;
+       return PJ_TRUE;
+}
+
+static void moh_disconnect(int callId)
+{
+       if (wav.moh_call_slot[callId] == PJSUA_INVALID_ID)
+               return;
+
+       if (wav.moh_slot != PJSUA_INVALID_ID)
+               pjsua_conf_disconnect(wav.moh_slot, wav.moh_call_slot[callId]);
+       wav.moh_call_slot[callId] = PJSUA_INVALID_ID;
+}
+
+/* Remove hold music source, calls are disconnected with it */
+static void moh_release(void)
+{
+       unsigned i;
+
+       if (wav.moh_slot != PJSUA_INVALID_ID) {
+               pjsua_conf_remove_port(wav.moh_slot);
+               wav.moh_slot = PJSUA_INVALID_ID;
+       }
+       for (i=0; i<PJSUA_MAX_CALLS; ++i)
+               wav.moh_call_slot[i] = PJSUA_INVALID_ID;
+       if (wav.moh_port) {
+               pjmedia_port_destroy(wav.moh_port);
+               wav.moh_port = NULL;
+       }
+       if (wav.moh_file) {
+               file_unref(wav.moh_file);
+               wav.moh_file = NULL;
+       }
+       if (wav.moh_pool) {
+               pj_pool_release(wav.moh_pool);
+               wav.moh_pool = NULL;
+       }
+}
+
+/* Connect music on hold to call put on hold locally, disconnect it
+   when call media is active again */
+void moh_on_call_media(int callId)
+{
+       pjsua_call_info call_info;
+       pj_bool_t connected = PJ_FALSE;
+
+       if (callId < 0 || callId >= PJSUA_MAX_CALLS || wav.mutex == NULL)
+               return;
+
+       if (pjsua_call_get_info(callId, &call_info) != PJ_SUCCESS)
+               return;
+
+       pj_mutex_lock(wav.mutex);
+       if (call_info.media_status == PJSUA_CALL_MEDIA_LOCAL_HOLD &&
+           call_info.conf_slot != PJSUA_INVALID_ID && call_info.conf_slot != 0)
+       {
+               // slot may change when media is recreated
+               if (wav.moh_call_slot[callId] != call_info.conf_slot)
+                       moh_disconnect(callId);
+               connected = moh_connect(callId, call_info.conf_slot);
+       }
+       else {
+               moh_disconnect(callId);
+       }
+       pj_mutex_unlock(wav.mutex);
+
+       if (connected && wav.on_call_source)
+               (*wav.on_call_source)(callId);
+}
+
+void moh_on_call_retrieve(int callId)
+{
+       if (callId < 0 || callId >= PJSUA_MAX_CALLS || wav.mutex == NULL)
+               return;
+
+       pj_mutex_lock(wav.mutex);
+       moh_disconnect(callId);
+       pj_mutex_unlock(wav.mutex);
+}
+
+/* Call media is already removed from the bridge with its connections */
+void moh_on_call_disconnected(int callId)
+{
+       if (callId < 0 || callId >= PJSUA_MAX_CALLS || wav.mutex == NULL)
+               return;
+
+       pj_mutex_lock(wav.mutex);
+       wav.moh_call_slot[callId] = PJSUA_INVALID_ID;
+       pj_mutex_unlock(wav.mutex);
+}
+
+/************************************************************
+  Set music on hold file, NULL or empty string disables it.
+  File is played in loop by single player connected to all
+  calls on hold.
+------------------------------------------------------------*/
+int dll_setHoldMusic(char* waveFile)
+{
+       pjsua_conf_port_info master;
+       pjsua_call_id call_ids[PJSUA_MAX_CALLS];
+       unsigned call_cnt = PJ_ARRAY_SIZE(call_ids);
+       unsigned i, ptime = 0;
+       pj_status_t status;
+
+       if (wav.mutex == NULL)
+               return PJ_EINVALIDOP;
+
+       if (waveFile != NULL && *waveFile != '\0') {
+               status = pjsua_conf_get_port_info(0, &master);
+               if (status != PJ_SUCCESS)
+                       return status;
+               ptime = master.samples_per_frame * 1000 / master.channel_count / master.clock_rate;
+       }
+
+       pj_mutex_lock(wav.mutex);
+
+       moh_release();
+
+       if (waveFile == NULL || *waveFile == '\0') {
+               pj_mutex_unlock(wav.mutex);
+               return PJ_SUCCESS;
+       }
+
+       wav.moh_file = file_ref(waveFile);
+       if (wav.moh_file == NULL) {
+               pj_mutex_unlock(wav.mutex);
+               PJ_LOG(2,(THIS_FILE, "Unable to map hold music %s", waveFile));
+               return PJ_ENOTFOUND;
+       }
+
+       wav.moh_pool = pjsua_pool_create("moh", 512, 512);
+       mapped_port_create(wav.moh_pool, wav.moh_file, ptime, PJ_TRUE, &wav.moh_port);
+
+       status = pjsua_conf_add_port(wav.moh_pool, wav.moh_port, &wav.moh_slot);
+       if (status != PJ_SUCCESS) {
+               wav.moh_slot = PJSUA_INVALID_ID;
+               moh_release();
+               pj_mutex_unlock(wav.mutex);
+               pjsua_perror(THIS_FILE, "Unable to add hold music", status);
+               return status;
+       }
+
+       pj_mutex_unlock(wav.mutex);
+
+       // calls already on hold
+       if (pjsua_enum_calls(call_ids, &call_cnt) == PJ_SUCCESS) {
+               for (i=0; i<call_cnt; ++i)
+                       moh_on_call_media(call_ids[i]);
+       }
+
+       PJ_LOG(4,(THIS_FILE, "Hold music set to %s", waveFile));
+       return PJ_SUCCESS;
+}
+
+
+/************************************************************
+  Barge-in
+------------------------------------------------------------*/
+
+/* Empty digit list matches any digit */
+static pj_bool_t bargein_match(pj_bool_t enabled, const char *digits, int digit)
+{
+       if (!enabled)
+               return PJ_FALSE;
+       return (digits[0] == '\0' || strchr(digits, digit) != NULL) ? PJ_TRUE : PJ_FALSE;
+}
+
+/************************************************************
+  Stop player when caller presses DTMF digit. digits lists
+  the digits that stop the player, empty string means any
+  digit and NULL disables barge-in.
+------------------------------------------------------------*/
+int dll_setBargeIn(int playerId, char* digits)
+{
+       pj_bool_t enabled = (digits != NULL);
+       char *dst;
+
+       if (wav.mutex == NULL || (digits && strlen(digits) > MAX_BARGEIN_DIGITS))
+               return PJ_EINVAL;
+
+       pj_mutex_lock(wav.mutex);
+
+       if (playerId >= PROMPT_PLAYER_BASE && playerId < PROMPT_PLAYER_BASE + MAX_PROMPT_PLAYERS &&
+           wav.players[playerId - PROMPT_PLAYER_BASE])
+       {
+               prompt_player *player = wav.players[playerId - PROMPT_PLAYER_BASE];
+               player->bargein = enabled;
+               dst = player->bargein_digits;
+       }
+       else if (playerId >= 0 && playerId < PJSUA_MAX_PLAYERS && wav.file_players[playerId].active)
+       {
+               wav.file_players[playerId].bargein = enabled;
+               dst = wav.file_players[playerId].bargeinDigits;
+       }
+       else
+       {
+               pj_mutex_unlock(wav.mutex);
+               return PJ_ENOTFOUND;
+       }
+
+       pj_ansi_strncpy(dst, enabled ? digits : "", MAX_BARGEIN_DIGITS);
+       dst[MAX_BARGEIN_DIGITS] = '\0';
+
+       pj_mutex_unlock(wav.mutex);
+       return PJ_SUCCESS;
+}
+
+/* Called from DTMF callback before the digit is passed to application.
+   Stops matching players of the call and reports them with
+   onBargeInCallback. Returns number of stopped players. */
+int wav_on_dtmf(int callId, int digit)
+{
+       int stopped[MAX_PROMPT_PLAYERS + PJSUA_MAX_PLAYERS];
+       int count = 0;
+       int i;
+
+       if (wav.mutex == NULL)
+               return 0;
+
+       pj_mutex_lock(wav.mutex);
+       for (i=0; i<MAX_PROMPT_PLAYERS; ++i) {
+               prompt_player *player = wav.players[i];
+
+               if (player && player->call_id == callId &&
+                   bargein_match(player->bargein, player->bargein_digits, digit))
+                       stopped[count++] = player->id;
+       }
+       for (i=0; i<PJSUA_MAX_PLAYERS; ++i) {
+               wavplayerEof_Data *data = &wav.file_players[i];
+
+               if (data->active && data->callId == callId &&
+                   bargein_match(data->bargein, data->bargeinDigits, digit))
+                       stopped[count++] = i;
+       }
+       pj_mutex_unlock(wav.mutex);
+
+       // stop all players first, so audio stops before managed code runs
+       for (i=0; i<count; ++i)
+               dll_releaseWav(stopped[i]);
+
+       for (i=0; i<count; ++i) {
+               PJ_LOG(4,(THIS_FILE, "Player %d on call %d stopped by DTMF %c", stopped[i], callId, digit));
+               if (cb_bargein != 0)
+                       (*cb_bargein)(callId, stopped[i], digit);
+       }
+
+       return count;
+}
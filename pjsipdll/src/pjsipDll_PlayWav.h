@@ -1,39 +1,70 @@
-/*
- * Copyright (C) 2007 Sasa Coh <sasacoh[at]gmail.com>
- *
- * Updated by Tanguy Floc'h <tanguy.floch[at]gmail.com>
- *
- * This program is free software; you can redistribute it and/or modify
- * it under the terms of the GNU General Public License as published by
- * the Free Software Foundation; either version 2 of the License, or
- * (at your option) any later version.
- *
- * This program is distributed in the hope that it will be useful,
- * but WITHOUT ANY WARRANTY; without even the implied warranty of
- * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
- * GNU General Public License for more details.
- *
- * You should have received a copy of the GNU General Public License
- * along with this program; if not, write to the Free Software
- * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
- */
-
- 
-// pjsipDll.h : Declares the entry point for the .Net GUI application.
-//
-
-#ifdef PJSIPDLL_EXPORTS
-       #define PJSIPDLL_DLL_API __declspec(dllexport)
-#else
-       #define PJSIPDLL_DLL_API __declspec(dllimport)
-#endif
-
-
-// calback function definitions
-typedef int __stdcall fptr_wavplayerEnded(int CallId, int PlayerId);
-
- 
-// Callback registration
-extern "C" PJSIPDLL_DLL_API int onWavPlayerEndedCallback(fptr_wavplayerEnded cb); // register Wav Player Eof notifier
-extern "C" PJSIPDLL_DLL_API int dll_playWav(char* waveFile, int callId);
-extern "C" PJSIPDLL_DLL_API bool dll_releaseWav(int playerId);
+/*
+ * Copyright (C) 2007 Sasa Coh <sasacoh[at]gmail.com>
+ *
+ * Updated by Tanguy Floc'h <tanguy.floch[at]gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+ 
+// pjsipDll.h : Declares the entry point for the .Net GUI application.
+//
+
+#ifdef LINUX
+       #define __stdcall
+       #define PJSIPDLL_DLL_API
+#else
+#ifdef PJSIPDLL_EXPORTS
+       #define PJSIPDLL_DLL_API __declspec(dllexport)
+#else
+       #define PJSIPDLL_DLL_API __declspec(dllimport)
+#endif
+#endif
+
+
+// calback function definitions
+typedef int __stdcall fptr_wavplayerEnded(int CallId, int PlayerId);
+typedef int __stdcall fptr_bargein(int CallId, int PlayerId, int digit);
+
+ 
+// Callback registration
+extern "C" PJSIPDLL_DLL_API int onWavPlayerEndedCallback(fptr_wavplayerEnded cb); // register Wav Player Eof notifier
+extern "C" PJSIPDLL_DLL_API int onBargeInCallback(fptr_bargein cb); // register player stopped by DTMF notifier
+extern "C" PJSIPDLL_DLL_API int dll_playWav(char* waveFile, int callId);
+extern "C" PJSIPDLL_DLL_API bool dll_releaseWav(int playerId);
+
+// Prompt cache, players are released with dll_releaseWav or dll_stopPrompt
+extern "C" PJSIPDLL_DLL_API int dll_preloadWav(char* waveFile);
+extern "C" PJSIPDLL_DLL_API int dll_releasePrompt(int promptId);
+extern "C" PJSIPDLL_DLL_API int dll_playPrompt(int promptId, int callId);
+extern "C" PJSIPDLL_DLL_API int dll_stopPrompt(int playerId);
+extern "C" PJSIPDLL_DLL_API int dll_playSequence(int callId, const int* promptIds, int count);
+
+// Memory mapped file player, file is mapped once for all concurrent players
+extern "C" PJSIPDLL_DLL_API int dll_playWavMapped(char* waveFile, int callId, bool loop);
+
+// Barge-in, stop player (any kind) on DTMF. NULL disables, "" stops on any digit
+extern "C" PJSIPDLL_DLL_API int dll_setBargeIn(int playerId, char* digits);
+
+// Music on hold, played to every call on local hold
+extern "C" PJSIPDLL_DLL_API int dll_setHoldMusic(char* waveFile);
+
+// Internal hooks called by pjsipDll.cpp
+int wav_init(void (*on_call_source)(int callId));
+void wav_destroy(void);
+void moh_on_call_media(int callId);
+void moh_on_call_retrieve(int callId);
+void moh_on_call_disconnected(int callId);
+int wav_on_dtmf(int callId, int digit);
@@ -0,0 +1,492 @@
+/*
+ * Copyright (C) 2007 Sasa Coh <sasacoh@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * This code is based on pjsip from Benny Prijono <benny@prijono.org>
+ *
+ */
+
+/*
+ * Buddy list loading.
+ *
+ * dll_addBuddies adds the whole contact list in one call without
+ * subscribing. Buddies are put in subscription queue and SUBSCRIBE
+ * requests are spread by a timer on the pjsip timer heap at configured
+ * rate, so loading a large list does not flood the presence server.
+ * Number of buddies is limited by PJSUA_MAX_BUDDIES of pjsua build.
+ *
+ * Presence coalescing.
+ *
+ * Server sends full state of the list in a burst of NOTIFY requests
+ * after subscribing or reconnecting. When onBuddyStatusBatchCallback is
+ * registered, latest state of each buddy is kept in a table and changed
+ * buddies are delivered together once per batch interval instead of one
+ * onBuddyStatusChangedCallback per NOTIFY. NOTIFY that does not change
+ * the state is not reported at all.
+ *
+ * Presence table.
+ *
+ * Latest state of every buddy is kept in a compact table indexed by
+ * buddy id, 6 bytes per buddy. Notes are interned: buddies with the same
+ * note ("Online", "Away", ...) share one reference counted string. Each
+ * change increments the table version, so dll_getPresenceVersion tells
+ * whether dll_getPresenceSnapshot would return anything new.
+ */
+
+#include "pjsipDll_Presence.h"
+#include <pjsua-lib/pjsua.h>
+
+#define THIS_FILE	"pjsipDll_Presence.cpp"
+#define SUBSCRIBE_TICK_MSEC	100
+#define PRES_TEXT_LEN		128
+
+#define PRES_MAX_NOTES		(PJSUA_MAX_BUDDIES + 2)
+
+/* Latest state of a buddy, note is index to interned notes */
+struct buddy_state
+{
+	pj_uint8_t	    used;
+	pj_uint8_t	    status;	/* pjsua_buddy_status		    */
+	pj_uint8_t	    activity;	/* pjrpid_activity		    */
+	pj_uint8_t	    dirty;	/* changed since last batch	    */
+	pj_uint16_t	    note;
+};
+
+/* Interned note, entry 0 is empty note */
+struct pres_note
+{
+	unsigned	    refcnt;
+	unsigned	    len;
+	char		    text[PRES_TEXT_LEN];
+};
+
+static struct pres_data
+{
+	pj_pool_t	   *pool;
+	pj_mutex_t	   *mutex;
+
+	/* buddies waiting for SUBSCRIBE, ring buffer */
+	int		    sub_queue[PJSUA_MAX_BUDDIES];
+	unsigned	    sub_head;
+	unsigned	    sub_count;
+	pj_timer_entry	    sub_timer;
+	pj_bool_t	    sub_scheduled;
+	unsigned	    sub_credit;	/* in 1/1000 SUBSCRIBE		    */
+
+	/* presence table, batch is used only by batch timer */
+	buddy_state	    buddies[PJSUA_MAX_BUDDIES];
+	pres_note	    notes[PRES_MAX_NOTES];
+	unsigned	    note_cnt;	/* highest used note + 1	    */
+	pj_uint32_t	    version;
+	unsigned	    dirty_cnt;
+	pj_timer_entry	    batch_timer;
+	pj_bool_t	    batch_scheduled;
+	BuddyStatusDelta    batch[PJSUA_MAX_BUDDIES];
+	char		    batch_text[PJSUA_MAX_BUDDIES][PRES_TEXT_LEN];
+} pres;
+
+// rate and interval may be set before dll_init
+static unsigned subscribe_rate = 20;
+static unsigned batch_interval = 500;
+
+static fptr_buddystatusbatch* cb_buddystatusbatch = 0;
+
+
+//////////////////////////////////////////////////////////////////////////
+// Interned notes, mutex must be held
+
+static unsigned note_intern(const char *text, unsigned len)
+{
+	unsigned i, free_idx = 0;
+
+	if (len == 0)
+		return 0;
+	if (len >= PRES_TEXT_LEN)
+		len = PRES_TEXT_LEN - 1;
+
+	for (i=1; i<pres.note_cnt; ++i) {
+		pres_note *n = &pres.notes[i];
+
+		if (n->refcnt == 0) {
+			if (free_idx == 0)
+				free_idx = i;
+			continue;
+		}
+		if (n->len == len && pj_memcmp(n->text, text, len) == 0) {
+			++n->refcnt;
+			return i;
+		}
+	}
+
+	// each buddy holds one note, table cannot be full
+	if (free_idx == 0)
+		free_idx = pres.note_cnt++;
+
+	pj_memcpy(pres.notes[free_idx].text, text, len);
+	pres.notes[free_idx].text[len] = '\0';
+	pres.notes[free_idx].len = len;
+	pres.notes[free_idx].refcnt = 1;
+
+	return free_idx;
+}
+
+static void note_release(unsigned idx)
+{
+	if (idx == 0 || pres.notes[idx].refcnt == 0)
+		return;
+
+	if (--pres.notes[idx].refcnt == 0) {
+		while (pres.note_cnt > 1 && pres.notes[pres.note_cnt - 1].refcnt == 0)
+			--pres.note_cnt;
+	}
+}
+
+
+//////////////////////////////////////////////////////////////////////////
+// Subscription queue
+
+/* Mutex must be held */
+static void sub_schedule(unsigned msec)
+{
+	pj_time_val delay = {0, 0};
+
+	if (pres.sub_scheduled || pres.sub_count == 0)
+		return;
+
+	delay.sec = msec / 1000;
+	delay.msec = msec % 1000;
+	if (pjsip_endpt_schedule_timer(pjsua_get_pjsip_endpt(), &pres.sub_timer, &delay) == PJ_SUCCESS)
+		pres.sub_scheduled = PJ_TRUE;
+}
+
+/* Subscribe next buddies, runs in pjsip worker. Rates below one buddy
+ * per tick subscribe one buddy per 1000/rate msec, faster rates keep
+ * fractional credit between ticks.
+ */
+static void sub_timer_cb(pj_timer_heap_t *timer_heap, struct pj_timer_entry *entry)
+{
+	int ids[PJSUA_MAX_BUDDIES];
+	unsigned count = 0, budget, tick = SUBSCRIBE_TICK_MSEC, i;
+
+	PJ_UNUSED_ARG(timer_heap);
+	PJ_UNUSED_ARG(entry);
+
+	pj_mutex_lock(pres.mutex);
+	pres.sub_scheduled = PJ_FALSE;
+
+	if (subscribe_rate == 0 ||
+	    subscribe_rate * SUBSCRIBE_TICK_MSEC / 1000 >= PJSUA_MAX_BUDDIES)
+	{
+		budget = PJSUA_MAX_BUDDIES;
+	} else if (subscribe_rate < 1000 / SUBSCRIBE_TICK_MSEC) {
+		budget = 1;
+		tick = 1000 / subscribe_rate;
+	} else {
+		pres.sub_credit += subscribe_rate * SUBSCRIBE_TICK_MSEC;
+		budget = pres.sub_credit / 1000;
+	}
+
+	while (pres.sub_count && count < budget) {
+		ids[count++] = pres.sub_queue[pres.sub_head];
+		pres.sub_head = (pres.sub_head + 1) % PJSUA_MAX_BUDDIES;
+		--pres.sub_count;
+	}
+
+	if (pres.sub_count == 0 || pres.sub_credit < count * 1000)
+		pres.sub_credit = 0;
+	else
+		pres.sub_credit -= count * 1000;
+
+	sub_schedule(tick);
+	pj_mutex_unlock(pres.mutex);
+
+	// pjsua takes its own lock
+	for (i=0; i<count; ++i) {
+		if (ids[i] != PJSUA_INVALID_ID && pjsua_buddy_is_valid(ids[i]))
+			pjsua_buddy_subscribe_pres(ids[i], PJ_TRUE);
+	}
+}
+
+/* Drop removed buddy from subscription queue and state table */
+void pres_on_buddy_removed(int buddyId)
+{
+	unsigned i;
+
+	if (pres.mutex == NULL)
+		return;
+
+	pj_mutex_lock(pres.mutex);
+	for (i=0; i<pres.sub_count; ++i) {
+		int *id = &pres.sub_queue[(pres.sub_head + i) % PJSUA_MAX_BUDDIES];
+		if (*id == buddyId)
+			*id = PJSUA_INVALID_ID;
+	}
+
+	if (buddyId >= 0 && buddyId < PJSUA_MAX_BUDDIES) {
+		buddy_state *b = &pres.buddies[buddyId];
+		if (b->dirty)
+			--pres.dirty_cnt;
+		if (b->used)
+			++pres.version;
+		note_release(b->note);
+		pj_bzero(b, sizeof(*b));
+	}
+	pj_mutex_unlock(pres.mutex);
+}
+
+
+//////////////////////////////////////////////////////////////////////////
+// Presence coalescing
+
+/* Deliver changed buddies, runs in pjsip worker */
+static void batch_timer_cb(pj_timer_heap_t *timer_heap, struct pj_timer_entry *entry)
+{
+	unsigned count = 0, i;
+
+	PJ_UNUSED_ARG(timer_heap);
+	PJ_UNUSED_ARG(entry);
+
+	pj_mutex_lock(pres.mutex);
+	pres.batch_scheduled = PJ_FALSE;
+	for (i=0; i<PJSUA_MAX_BUDDIES && pres.dirty_cnt; ++i) {
+		buddy_state *b = &pres.buddies[i];
+
+		if (!b->dirty)
+			continue;
+		b->dirty = PJ_FALSE;
+		--pres.dirty_cnt;
+
+		pj_memcpy(pres.batch_text[count], pres.notes[b->note].text,
+			  pres.notes[b->note].len + 1);
+		pres.batch[count].buddyId = i;
+		pres.batch[count].status = b->status;
+		pres.batch[count].statusText = pres.batch_text[count];
+		++count;
+	}
+	pj_mutex_unlock(pres.mutex);
+
+	if (count && cb_buddystatusbatch != 0)
+		(*cb_buddystatusbatch)(pres.batch, count);
+}
+
+/* Store state of buddy from on_buddy_state. Returns nonzero when state is
+ * delivered in batch and must not be reported per buddy.
+ */
+int pres_on_buddy_state(int buddyId, int status, int activity, const char *text, int textLen)
+{
+	buddy_state *b;
+	unsigned note;
+	pj_bool_t batch = (cb_buddystatusbatch != 0);
+
+	if (pres.mutex == NULL || buddyId < 0 || buddyId >= PJSUA_MAX_BUDDIES)
+		return 0;
+
+	// final NOTIFY of a deleted buddy must not bring its entry back
+	if (!pjsua_buddy_is_valid(buddyId))
+		return 0;
+
+	b = &pres.buddies[buddyId];
+
+	pj_mutex_lock(pres.mutex);
+	note = note_intern(text, textLen > 0 ? textLen : 0);
+
+	if (b->used && b->status == status && b->activity == activity && b->note == note) {
+		note_release(note);
+		pj_mutex_unlock(pres.mutex);
+		return batch;
+	}
+
+	note_release(b->note);
+	b->used = 1;
+	b->status = (pj_uint8_t) status;
+	b->activity = (pj_uint8_t) activity;
+	b->note = (pj_uint16_t) note;
+	++pres.version;
+
+	if (batch) {
+		if (!b->dirty) {
+			b->dirty = 1;
+			++pres.dirty_cnt;
+		}
+
+		if (!pres.batch_scheduled) {
+			pj_time_val delay = {0, 0};
+
+			delay.msec = batch_interval;
+			PJ_TIME_VAL_NORMALIZE(delay);
+			if (pjsip_endpt_schedule_timer(pjsua_get_pjsip_endpt(), &pres.batch_timer,
+						       &delay) == PJ_SUCCESS)
+			{
+				pres.batch_scheduled = PJ_TRUE;
+			}
+		}
+	}
+	pj_mutex_unlock(pres.mutex);
+
+	return batch;
+}
+
+
+//////////////////////////////////////////////////////////////////////////
+// Init/destroy
+
+int pres_init(void)
+{
+	pj_status_t status;
+
+	pj_bzero(&pres, sizeof(pres));
+	pres.note_cnt = 1;
+
+	pres.pool = pjsua_pool_create("pres", 1000, 1000);
+
+	status = pj_mutex_create_simple(pres.pool, "pres", &pres.mutex);
+	if (status != PJ_SUCCESS)
+		return status;
+
+	pj_timer_entry_init(&pres.sub_timer, 0, NULL, &sub_timer_cb);
+	pj_timer_entry_init(&pres.batch_timer, 0, NULL, &batch_timer_cb);
+
+	return PJ_SUCCESS;
+}
+
+void pres_destroy(void)
+{
+	if (pres.pool == NULL)
+		return;
+
+	if (pres.sub_scheduled)
+		pjsip_endpt_cancel_timer(pjsua_get_pjsip_endpt(), &pres.sub_timer);
+	if (pres.batch_scheduled)
+		pjsip_endpt_cancel_timer(pjsua_get_pjsip_endpt(), &pres.batch_timer);
+
+	if (pres.mutex)
+		pj_mutex_destroy(pres.mutex);
+	pj_pool_release(pres.pool);
+	pj_bzero(&pres, sizeof(pres));
+}
+
+
+//////////////////////////////////////////////////////////////////////////
+// API
+
+int onBuddyStatusBatchCallback(fptr_buddystatusbatch cb)
+{
+	cb_buddystatusbatch = cb;
+	return 1;
+}
+
+/* Add buddies without subscribing, then queue their subscriptions.
+ * outIds receives buddy id or -1 for each uri. Returns number of buddies
+ * added.
+ */
+int dll_addBuddies(const char** uris, int count, int* outIds)
+{
+	pjsua_buddy_config buddy_cfg;
+	int added = 0;
+	int i;
+
+	if (uris == NULL || count < 0 || pres.mutex == NULL)
+		return -1;
+
+	pjsua_buddy_config_default(&buddy_cfg);
+	buddy_cfg.subscribe = PJ_FALSE;
+
+	for (i=0; i<count; ++i) {
+		int buddyId = PJSUA_INVALID_ID;
+
+		if (uris[i] != NULL) {
+			buddy_cfg.uri = pj_str((char*)uris[i]);
+			if (pjsua_buddy_add(&buddy_cfg, &buddyId) != PJ_SUCCESS)
+				buddyId = PJSUA_INVALID_ID;
+		}
+
+		if (outIds)
+			outIds[i] = buddyId;
+
+		if (buddyId == PJSUA_INVALID_ID)
+			continue;
+		++added;
+
+		pj_mutex_lock(pres.mutex);
+		if (pres.sub_count < PJSUA_MAX_BUDDIES) {
+			pres.sub_queue[(pres.sub_head + pres.sub_count) % PJSUA_MAX_BUDDIES] = buddyId;
+			++pres.sub_count;
+		}
+		pj_mutex_unlock(pres.mutex);
+	}
+
+	pj_mutex_lock(pres.mutex);
+	sub_schedule(0);
+	pj_mutex_unlock(pres.mutex);
+
+	if (added < count)
+		PJ_LOG(2,(THIS_FILE, "%d of %d buddies could not be added", count - added, count));
+
+	return added;
+}
+
+int dll_setSubscribeRate(int perSecond)
+{
+	if (perSecond < 0)
+		return PJ_EINVAL;
+
+	subscribe_rate = perSecond;
+	return PJ_SUCCESS;
+}
+
+int dll_setBuddyStatusBatchInterval(int intervalMs)
+{
+	if (intervalMs < 0)
+		return PJ_EINVAL;
+
+	batch_interval = intervalMs;
+	return PJ_SUCCESS;
+}
+
+/* Copy state of all buddies with known presence. Returns number of
+ * entries written.
+ */
+int dll_getPresenceSnapshot(PresenceEntry* entries, int maxCount)
+{
+	int count = 0;
+	unsigned i;
+
+	if (entries == NULL || maxCount < 0 || pres.mutex == NULL)
+		return -1;
+
+	pj_mutex_lock(pres.mutex);
+	for (i=0; i<PJSUA_MAX_BUDDIES && count < maxCount; ++i) {
+		const buddy_state *b = &pres.buddies[i];
+		const pres_note *n = &pres.notes[b->note];
+
+		if (!b->used)
+			continue;
+
+		entries[count].buddyId = i;
+		entries[count].status = b->status;
+		entries[count].activity = b->activity;
+		pj_memcpy(entries[count].note, n->text, n->len + 1);
+		++count;
+	}
+	pj_mutex_unlock(pres.mutex);
+
+	return count;
+}
+
+int dll_getPresenceVersion()
+{
+	return (int) pres.version;
+}
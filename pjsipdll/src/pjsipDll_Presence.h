@@ -0,0 +1,75 @@
+/*
+ * Copyright (C) 2007 Sasa Coh <sasacoh@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+// pjsipDll_Presence.h : Buddy list loading, presence coalescing and presence table
+//
+
+#ifdef LINUX
+	#define __stdcall
+	#define PJSIPDLL_DLL_API
+#else
+#ifdef PJSIPDLL_EXPORTS
+	#define PJSIPDLL_DLL_API __declspec(dllexport)
+#else
+	#define PJSIPDLL_DLL_API __declspec(dllimport)
+#endif
+#endif
+
+// Changed buddy state delivered by onBuddyStatusBatchCallback
+struct BuddyStatusDelta
+{
+	int buddyId;
+	int status;				// pjsua_buddy_status
+	const char* statusText;	// valid during callback only
+};
+
+// Activity reported in PresenceEntry
+enum EPresenceActivity
+{
+	PRES_ACTIVITY_UNKNOWN,
+	PRES_ACTIVITY_AWAY,
+	PRES_ACTIVITY_BUSY
+};
+
+// Buddy state returned by dll_getPresenceSnapshot
+struct PresenceEntry
+{
+	int buddyId;
+	int status;				// pjsua_buddy_status
+	int activity;			// EPresenceActivity
+	char note[128];
+};
+
+// calback function definitions
+typedef int __stdcall fptr_buddystatusbatch(const BuddyStatusDelta* deltas, int count);
+
+// Callback registration
+extern "C" PJSIPDLL_DLL_API int onBuddyStatusBatchCallback(fptr_buddystatusbatch cb); // register coalesced buddy status notifier
+
+// Buddy list API
+extern "C" PJSIPDLL_DLL_API int dll_addBuddies(const char** uris, int count, int* outIds);
+extern "C" PJSIPDLL_DLL_API int dll_setSubscribeRate(int perSecond);	// 0 subscribes all at once
+extern "C" PJSIPDLL_DLL_API int dll_setBuddyStatusBatchInterval(int intervalMs);
+extern "C" PJSIPDLL_DLL_API int dll_getPresenceSnapshot(PresenceEntry* entries, int maxCount);
+extern "C" PJSIPDLL_DLL_API int dll_getPresenceVersion();	// changes whenever snapshot would change
+
+// Internal hooks called by pjsipDll.cpp
+int pres_init(void);
+void pres_destroy(void);
+void pres_on_buddy_removed(int buddyId);
+int pres_on_buddy_state(int buddyId, int status, int activity, const char *text, int textLen);
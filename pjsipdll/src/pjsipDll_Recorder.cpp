@@ -0,0 +1,740 @@
+/*
+ * Copyright (C) 2007 Sasa Coh <sasacoh@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * This code is based on pjsip from Benny Prijono <benny@prijono.org>
+ *
+ */
+
+/*
+ * Per call recording.
+ *
+ * Each recording has one recorder port per recorded direction in the
+ * conference bridge. Mono recording connects the call and all ports
+ * transmitting to the call to a single port. Stereo recording uses two
+ * ports, left channel gets audio received from the call, right channel
+ * gets audio sent to the call.
+ *
+ * Recorder ports only encode frames into the recording's ring buffer,
+ * the file is written by a single background writer thread in large
+ * chunks, so disk access never runs on the media clock thread.
+ *
+ * The ring buffer is single producer (media clock) single consumer
+ * (writer thread) and lock free. Read and write positions are free
+ * running counters, each is written by one side only and published
+ * with atomic set. When the disk falls behind, whole frames are dropped
+ * and counted instead of blocking the clock.
+ */
+
+#include "pjsipDll_Recorder.h"
+#include <pjsua-lib/pjsua.h>
+
+#define THIS_FILE	"pjsipDll_Recorder.cpp"
+#define SIGNATURE	PJMEDIA_PORT_SIGNATURE('S', 'R', 'E', 'C')
+#define REC_MAX		PJSUA_MAX_CALLS
+#define REC_BUFFER_SIZE	(256*1024)	/* must be power of two		    */
+#define REC_WRITE_SIZE	(32*1024)	/* writer is woken at this fill	    */
+#define REC_PCM_HDR_LEN	44
+#define REC_G711_HDR_LEN 58
+
+struct call_rec;
+
+/* Recorder port, one for each recorded channel */
+struct rec_port
+{
+	pjmedia_port	    base;
+	call_rec	   *rec;
+	unsigned	    channel;
+	pjsua_conf_port_id  slot;
+};
+
+struct call_rec
+{
+	pj_pool_t	   *pool;
+	pjsua_call_id	    call_id;
+	int		    format;
+	unsigned	    channel_count;
+	unsigned	    bytes_per_sample;
+	unsigned	    clock_rate;
+	unsigned	    samples_per_frame;
+	rec_port	    ports[2];
+
+	/* media thread */
+	pj_int16_t	   *frame[2];	/* frames of current tick	    */
+	pj_bool_t	    have[2];
+	pj_int16_t	   *pcm;	/* interleaved frame		    */
+	pj_uint8_t	   *enc;	/* encoded frame		    */
+
+	/* ring buffer */
+	pj_uint8_t	   *buf;
+	pj_atomic_t	   *head;	/* written by media thread	    */
+	pj_atomic_t	   *tail;	/* written by writer thread	    */
+	pj_atomic_t	   *signaled;	/* writer has been woken	    */
+	unsigned	    max_fill;
+	unsigned	    dropped_frames;
+	unsigned	    dropped_bytes;
+
+	/* writer thread */
+	pj_oshandle_t	    fd;
+	unsigned	    hdr_len;
+	pj_uint32_t	    data_size;
+	unsigned	    writes;
+	pj_bool_t	    closing;
+};
+
+static struct rec_data
+{
+	pj_pool_t	   *pool;
+	pj_mutex_t	   *mutex;
+	pj_sem_t	   *sem;
+	pj_thread_t	   *thread;
+	pj_bool_t	    quit;
+	call_rec	   *list[REC_MAX];	/* all recordings, incl. closing    */
+	call_rec	   *calls[PJSUA_MAX_CALLS]; /* changed under mutex	    */
+	call_rec	   *file_rec;		/* app_config.rec_file recorder	    */
+} rec;
+
+
+//////////////////////////////////////////////////////////////////////////
+// WAV header
+
+static pj_uint8_t *put16(pj_uint8_t *p, pj_uint16_t v)
+{
+	p[0] = (pj_uint8_t)(v & 0xFF);
+	p[1] = (pj_uint8_t)(v >> 8);
+	return p + 2;
+}
+
+static pj_uint8_t *put32(pj_uint8_t *p, pj_uint32_t v)
+{
+	p = put16(p, (pj_uint16_t)(v & 0xFFFF));
+	return put16(p, (pj_uint16_t)(v >> 16));
+}
+
+static pj_uint8_t *put_tag(pj_uint8_t *p, const char *tag)
+{
+	pj_memcpy(p, tag, 4);
+	return p + 4;
+}
+
+/* G.711 files need extended fmt chunk and fact chunk */
+static pj_status_t rec_write_header(call_rec *r)
+{
+	pj_uint8_t hdr[REC_G711_HDR_LEN];
+	pj_uint8_t *p = hdr;
+	pj_bool_t pcm = (r->bytes_per_sample == 2);
+	pj_uint16_t tag;
+	pj_ssize_t size;
+
+	switch (r->format & 0xFF) {
+	case REC_FORMAT_ULAW: tag = 7; break;
+	case REC_FORMAT_ALAW: tag = 6; break;
+	default: tag = 1; break;
+	}
+
+	r->hdr_len = pcm ? REC_PCM_HDR_LEN : REC_G711_HDR_LEN;
+
+	p = put_tag(p, "RIFF");
+	p = put32(p, r->hdr_len - 8 + r->data_size);
+	p = put_tag(p, "WAVE");
+	p = put_tag(p, "fmt ");
+	p = put32(p, pcm ? 16 : 18);
+	p = put16(p, tag);
+	p = put16(p, (pj_uint16_t)r->channel_count);
+	p = put32(p, r->clock_rate);
+	p = put32(p, r->clock_rate * r->channel_count * r->bytes_per_sample);
+	p = put16(p, (pj_uint16_t)(r->channel_count * r->bytes_per_sample));
+	p = put16(p, (pj_uint16_t)(r->bytes_per_sample * 8));
+	if (!pcm) {
+		p = put16(p, 0);
+		p = put_tag(p, "fact");
+		p = put32(p, 4);
+		p = put32(p, r->data_size / (r->channel_count * r->bytes_per_sample));
+	}
+	p = put_tag(p, "data");
+	p = put32(p, r->data_size);
+
+	size = r->hdr_len;
+	return pj_file_write(r->fd, hdr, &size);
+}
+
+
+static void rec_free(call_rec *r)
+{
+	if (r->head)
+		pj_atomic_destroy(r->head);
+	if (r->tail)
+		pj_atomic_destroy(r->tail);
+	if (r->signaled)
+		pj_atomic_destroy(r->signaled);
+	pj_pool_release(r->pool);
+}
+
+
+//////////////////////////////////////////////////////////////////////////
+// Media thread
+
+static void rec_buffer_write(call_rec *r, const void *data, pj_uint32_t len)
+{
+	pj_uint32_t head = (pj_uint32_t) pj_atomic_get(r->head);
+	pj_uint32_t tail = (pj_uint32_t) pj_atomic_get(r->tail);
+	pj_uint32_t pos, part, fill;
+
+	if (REC_BUFFER_SIZE - (head - tail) < len) {
+		// disk is too slow, drop the frame
+		++r->dropped_frames;
+		r->dropped_bytes += len;
+		return;
+	}
+
+	pos = head & (REC_BUFFER_SIZE - 1);
+	part = REC_BUFFER_SIZE - pos;
+	if (part > len)
+		part = len;
+	pj_memcpy(r->buf + pos, data, part);
+	pj_memcpy(r->buf, (const pj_uint8_t*)data + part, len - part);
+
+	// publish data to writer
+	head += len;
+	pj_atomic_set(r->head, (pj_atomic_value_t)head);
+
+	fill = head - tail;
+	if (fill > r->max_fill)
+		r->max_fill = fill;
+
+	if (fill >= REC_WRITE_SIZE && pj_atomic_get(r->signaled) == 0) {
+		pj_atomic_set(r->signaled, 1);
+		pj_sem_post(rec.sem);
+	}
+}
+
+/* Encode frames of current tick */
+static void rec_emit(call_rec *r)
+{
+	unsigned count = r->samples_per_frame * r->channel_count;
+	const pj_int16_t *pcm = r->frame[0];
+	unsigned i;
+
+	if (r->channel_count == 2) {
+		for (i=0; i<r->samples_per_frame; ++i) {
+			r->pcm[2*i] = r->frame[0][i];
+			r->pcm[2*i+1] = r->frame[1][i];
+		}
+		pcm = r->pcm;
+	}
+	r->have[0] = r->have[1] = PJ_FALSE;
+
+	switch (r->format & 0xFF) {
+	case REC_FORMAT_ULAW:
+		for (i=0; i<count; ++i)
+			r->enc[i] = pjmedia_linear2ulaw(pcm[i]);
+		rec_buffer_write(r, r->enc, count);
+		break;
+	case REC_FORMAT_ALAW:
+		for (i=0; i<count; ++i)
+			r->enc[i] = pjmedia_linear2alaw(pcm[i]);
+		rec_buffer_write(r, r->enc, count);
+		break;
+	default:
+		rec_buffer_write(r, pcm, count * sizeof(pj_int16_t));
+		break;
+	}
+}
+
+static pj_status_t rec_put_frame(pjmedia_port *this_port, const pjmedia_frame *frame)
+{
+	rec_port *port = (rec_port*) this_port;
+	call_rec *r = port->rec;
+	unsigned ch = port->channel;
+	pj_size_t size = r->samples_per_frame * sizeof(pj_int16_t);
+
+	// other channel missed this tick, write it as silence
+	if (r->have[ch]) {
+		pj_bzero(r->frame[1-ch], size);
+		rec_emit(r);
+	}
+
+	if (frame->type == PJMEDIA_FRAME_TYPE_AUDIO && frame->size >= size)
+		pj_memcpy(r->frame[ch], frame->buf, size);
+	else
+		pj_bzero(r->frame[ch], size);
+	r->have[ch] = PJ_TRUE;
+
+	if (r->channel_count == 1 || (r->have[0] && r->have[1]))
+		rec_emit(r);
+
+	return PJ_SUCCESS;
+}
+
+
+//////////////////////////////////////////////////////////////////////////
+// Writer thread
+
+/* Write all buffered data to file, coalesced into one write or two
+ * when the buffer wraps
+ */
+static void rec_drain(call_rec *r)
+{
+	pj_uint32_t head, tail, pos;
+	pj_ssize_t len;
+	pj_status_t status;
+
+	// clear before reading head, so new data wakes the writer again
+	pj_atomic_set(r->signaled, 0);
+	head = (pj_uint32_t) pj_atomic_get(r->head);
+	tail = (pj_uint32_t) pj_atomic_get(r->tail);
+
+	while (tail != head) {
+		pos = tail & (REC_BUFFER_SIZE - 1);
+		len = REC_BUFFER_SIZE - pos;
+		if ((pj_uint32_t)len > head - tail)
+			len = head - tail;
+
+		status = pj_file_write(r->fd, r->buf + pos, &len);
+		if (status != PJ_SUCCESS) {
+			pjsua_perror(THIS_FILE, "Error writing recording", status);
+			len = head - tail;	// discard, keep media running
+		} else {
+			r->data_size += len;
+			++r->writes;
+		}
+
+		// release space to media thread
+		tail += len;
+		pj_atomic_set(r->tail, (pj_atomic_value_t)tail);
+	}
+}
+
+/* Update header, close the file and free recording */
+static void rec_close(call_rec *r)
+{
+	pj_file_setpos(r->fd, 0, PJ_SEEK_SET);
+	rec_write_header(r);
+	pj_file_close(r->fd);
+
+	if (r->dropped_frames)
+		PJ_LOG(2,(THIS_FILE, "Recording of call %d dropped %u frames", r->call_id, r->dropped_frames));
+	PJ_LOG(4,(THIS_FILE, "Recording of call %d closed, %u bytes in %u writes",
+		  r->call_id, r->data_size, r->writes));
+
+	rec_free(r);
+}
+
+static void rec_flush_all(void)
+{
+	call_rec *list[REC_MAX];
+	unsigned i;
+
+	// only writer thread removes recordings from the list
+	pj_mutex_lock(rec.mutex);
+	pj_memcpy(list, rec.list, sizeof(list));
+	pj_mutex_unlock(rec.mutex);
+
+	for (i=0; i<REC_MAX; ++i) {
+		call_rec *r = list[i];
+		pj_bool_t closing;
+
+		if (r == NULL)
+			continue;
+
+		// set before the semaphore is posted
+		closing = r->closing;
+
+		rec_drain(r);
+
+		if (closing) {
+			pj_mutex_lock(rec.mutex);
+			rec.list[i] = NULL;
+			pj_mutex_unlock(rec.mutex);
+
+			rec_close(r);
+		}
+	}
+}
+
+static int rec_writer_thread(void *arg)
+{
+	PJ_UNUSED_ARG(arg);
+
+	while (!rec.quit) {
+		pj_sem_wait(rec.sem);
+		rec_flush_all();
+	}
+	rec_flush_all();
+
+	return 0;
+}
+
+
+//////////////////////////////////////////////////////////////////////////
+// Bridge connections
+
+/* Connect recorder ports to the call and to all ports sending to the call.
+ * Call slot is looked up by the caller before mutex is taken, pjsua locks it.
+ */
+static void rec_connect(call_rec *r, pjsua_conf_port_id call_slot)
+{
+	pjsua_conf_port_id rx_slot = r->ports[0].slot;
+	pjsua_conf_port_id tx_slot = r->ports[r->channel_count-1].slot;
+	pjsua_conf_port_id ids[PJSUA_MAX_CONF_PORTS];
+	unsigned count = PJ_ARRAY_SIZE(ids);
+	unsigned i, j;
+
+	if (call_slot == PJSUA_INVALID_ID)
+		return;
+
+	pjsua_conf_connect(call_slot, rx_slot);
+
+	if (pjsua_enum_conf_ports(ids, &count) != PJ_SUCCESS)
+		return;
+
+	for (i=0; i<count; ++i) {
+		pjsua_conf_port_info info;
+
+		if (ids[i] == call_slot || ids[i] == rx_slot || ids[i] == tx_slot)
+			continue;
+		if (pjsua_conf_get_port_info(ids[i], &info) != PJ_SUCCESS)
+			continue;
+
+		for (j=0; j<info.listener_cnt; ++j) {
+			if (info.listeners[j] == call_slot) {
+				pjsua_conf_connect(ids[i], tx_slot);
+				break;
+			}
+		}
+	}
+}
+
+static pj_status_t rec_create(pjsua_call_id call_id, const char *path, int format,
+			      call_rec **p_rec)
+{
+	pjsua_conf_port_info master;
+	pj_pool_t *pool;
+	call_rec *r;
+	pj_size_t size;
+	unsigned i;
+	pj_status_t status;
+
+	status = pjsua_conf_get_port_info(0, &master);
+	if (status != PJ_SUCCESS)
+		return status;
+
+	pool = pjsua_pool_create("rec", REC_BUFFER_SIZE + 4000, 4000);
+	r = PJ_POOL_ZALLOC_T(pool, call_rec);
+	r->pool = pool;
+	r->call_id = call_id;
+	r->format = format;
+	r->channel_count = (format & REC_FORMAT_STEREO) ? 2 : 1;
+	r->bytes_per_sample = ((format & 0xFF) == REC_FORMAT_PCM16) ? 2 : 1;
+	r->clock_rate = master.clock_rate;
+	r->samples_per_frame = master.samples_per_frame / master.channel_count;
+	r->fd = NULL;
+	r->ports[0].slot = r->ports[1].slot = PJSUA_INVALID_ID;
+
+	size = r->samples_per_frame * sizeof(pj_int16_t);
+	r->frame[0] = (pj_int16_t*) pj_pool_zalloc(pool, size);
+	r->frame[1] = (pj_int16_t*) pj_pool_zalloc(pool, size);
+	r->pcm = (pj_int16_t*) pj_pool_zalloc(pool, size * 2);
+	r->enc = (pj_uint8_t*) pj_pool_zalloc(pool, size);
+	r->buf = (pj_uint8_t*) pj_pool_alloc(pool, REC_BUFFER_SIZE);
+
+	if ((status = pj_atomic_create(pool, 0, &r->head)) != PJ_SUCCESS ||
+	    (status = pj_atomic_create(pool, 0, &r->tail)) != PJ_SUCCESS ||
+	    (status = pj_atomic_create(pool, 0, &r->signaled)) != PJ_SUCCESS)
+	{
+		goto on_error;
+	}
+
+	status = pj_file_open(pool, path, PJ_O_WRONLY, &r->fd);
+	if (status != PJ_SUCCESS)
+		goto on_error;
+
+	// placeholder, sizes are written when recording is closed
+	status = rec_write_header(r);
+	if (status != PJ_SUCCESS)
+		goto on_error;
+
+	for (i=0; i<r->channel_count; ++i) {
+		rec_port *port = &r->ports[i];
+		pj_str_t name = pj_str((char*)(i == 0 ? "rec-rx" : "rec-tx"));
+
+		pjmedia_port_info_init(&port->base.info, &name, SIGNATURE, r->clock_rate,
+				       1, 16, r->samples_per_frame);
+		port->base.put_frame = &rec_put_frame;
+		port->rec = r;
+		port->channel = i;
+
+		status = pjsua_conf_add_port(pool, &port->base, &port->slot);
+		if (status != PJ_SUCCESS)
+			goto on_error;
+	}
+
+	// hand over to writer, closing recordings are still in the list
+	pj_mutex_lock(rec.mutex);
+	for (i=0; i<REC_MAX; ++i) {
+		if (rec.list[i] == NULL) {
+			rec.list[i] = r;
+			break;
+		}
+	}
+	pj_mutex_unlock(rec.mutex);
+
+	if (i == REC_MAX) {
+		status = PJ_ETOOMANY;
+		goto on_error;
+	}
+
+	*p_rec = r;
+	return PJ_SUCCESS;
+
+on_error:
+	for (i=0; i<r->channel_count; ++i) {
+		if (r->ports[i].slot != PJSUA_INVALID_ID)
+			pjsua_conf_remove_port(r->ports[i].slot);
+	}
+	if (r->fd)
+		pj_file_close(r->fd);
+	rec_free(r);
+	return status;
+}
+
+/* Detach recording from the bridge and let writer close it */
+static void rec_stop(call_rec *r)
+{
+	unsigned i;
+
+	// recorder ports are not called after they are removed from bridge
+	for (i=0; i<r->channel_count; ++i)
+		pjsua_conf_remove_port(r->ports[i].slot);
+
+	r->closing = PJ_TRUE;
+	pj_sem_post(rec.sem);
+}
+
+
+//////////////////////////////////////////////////////////////////////////
+// Internal hooks
+
+int rec_init(void)
+{
+	pj_status_t status;
+
+	pj_bzero(&rec, sizeof(rec));
+
+	rec.pool = pjsua_pool_create("recwriter", 1000, 1000);
+
+	status = pj_mutex_create_simple(rec.pool, "recwriter", &rec.mutex);
+	if (status != PJ_SUCCESS)
+		return status;
+
+	status = pj_sem_create(rec.pool, "recwriter", 0, REC_MAX * 2 + 1, &rec.sem);
+	if (status != PJ_SUCCESS)
+		return status;
+
+	status = pj_thread_create(rec.pool, "recwriter", &rec_writer_thread, NULL,
+				  0, 0, &rec.thread);
+	if (status != PJ_SUCCESS) {
+		pjsua_perror(THIS_FILE, "Unable to create recording writer thread", status);
+		return status;
+	}
+
+	return PJ_SUCCESS;
+}
+
+void rec_destroy(void)
+{
+	unsigned i;
+
+	if (rec.pool == NULL)
+		return;
+
+	for (i=0; i<PJ_ARRAY_SIZE(rec.calls); ++i) {
+		if (rec.calls[i])
+			dll_stopRecording(i);
+	}
+
+	if (rec.file_rec) {
+		rec_stop(rec.file_rec);
+		rec.file_rec = NULL;
+	}
+
+	if (rec.thread) {
+		rec.quit = PJ_TRUE;
+		pj_sem_post(rec.sem);
+		pj_thread_join(rec.thread);
+		pj_thread_destroy(rec.thread);
+	}
+	if (rec.sem)
+		pj_sem_destroy(rec.sem);
+	if (rec.mutex)
+		pj_mutex_destroy(rec.mutex);
+	pj_pool_release(rec.pool);
+
+	pj_bzero(&rec, sizeof(rec));
+}
+
+/* Create recorder for app_config.rec_file, calls and sound device are
+ * connected to its slot by the caller
+ */
+int rec_create_file(const char *path, int *p_slot)
+{
+	pj_status_t status;
+
+	if (rec.thread == NULL)
+		return PJ_EINVALIDOP;
+	if (rec.file_rec)
+		return PJ_EEXISTS;
+
+	status = rec_create(PJSUA_INVALID_ID, path, REC_FORMAT_PCM16, &rec.file_rec);
+	if (status != PJ_SUCCESS)
+		return status;
+
+	*p_slot = rec.file_rec->ports[0].slot;
+	return PJ_SUCCESS;
+}
+
+/* Call media has been (re)created or a new source has been connected to
+ * the call, connect recorder to the call slot and to all its sources.
+ * Modules call it after connecting a player or generator, without their
+ * mutex held. Recording can't be stopped and freed by writer while mutex
+ * is held.
+ */
+void rec_on_call_media(int callId)
+{
+	pjsua_conf_port_id call_slot;
+
+	if (callId < 0 || callId >= (int)PJ_ARRAY_SIZE(rec.calls) || rec.mutex == NULL)
+		return;
+
+	if (!pjsua_call_has_media(callId))
+		return;
+
+	call_slot = pjsua_call_get_conf_port(callId);
+
+	pj_mutex_lock(rec.mutex);
+	if (rec.calls[callId])
+		rec_connect(rec.calls[callId], call_slot);
+	pj_mutex_unlock(rec.mutex);
+}
+
+void rec_on_call_disconnected(int callId)
+{
+	if (callId < 0 || callId >= (int)PJ_ARRAY_SIZE(rec.calls) || rec.mutex == NULL)
+		return;
+
+	dll_stopRecording(callId);
+}
+
+
+//////////////////////////////////////////////////////////////////////////
+// Public API
+
+int dll_startRecording(int callId, char* path, int format)
+{
+	call_rec *r;
+	pjsua_conf_port_id call_slot = PJSUA_INVALID_ID;
+	pj_status_t status;
+
+	if (callId < 0 || callId >= (int)PJ_ARRAY_SIZE(rec.calls) || path == NULL)
+		return PJ_EINVAL;
+
+	if ((format & 0xFF) > REC_FORMAT_ALAW || (format & ~(0xFF | REC_FORMAT_STEREO)))
+		return PJ_EINVAL;
+
+	if (rec.thread == NULL || !pjsua_call_is_active(callId))
+		return PJ_EINVALIDOP;
+
+	if (rec.calls[callId])
+		return PJ_EEXISTS;
+
+	status = rec_create(callId, path, format, &r);
+	if (status != PJ_SUCCESS) {
+		pjsua_perror(THIS_FILE, "Unable to start recording", status);
+		return status;
+	}
+
+	if (pjsua_call_has_media(callId))
+		call_slot = pjsua_call_get_conf_port(callId);
+
+	pj_mutex_lock(rec.mutex);
+	if (rec.calls[callId]) {
+		// started by another thread meanwhile
+		pj_mutex_unlock(rec.mutex);
+		rec_stop(r);
+		return PJ_EEXISTS;
+	}
+	rec.calls[callId] = r;
+	rec_connect(r, call_slot);
+	pj_mutex_unlock(rec.mutex);
+
+	PJ_LOG(4,(THIS_FILE, "Recording call %d to %s", callId, path));
+
+	return PJ_SUCCESS;
+}
+
+int dll_stopRecording(int callId)
+{
+	call_rec *r;
+
+	if (callId < 0 || callId >= (int)PJ_ARRAY_SIZE(rec.calls))
+		return PJ_EINVAL;
+
+	if (rec.mutex == NULL)
+		return PJ_EINVALIDOP;
+
+	// only the thread that takes the recording out of the table stops it
+	pj_mutex_lock(rec.mutex);
+	r = rec.calls[callId];
+	rec.calls[callId] = NULL;
+	pj_mutex_unlock(rec.mutex);
+
+	if (r == NULL)
+		return PJ_ENOTFOUND;
+
+	rec_stop(r);
+
+	return PJ_SUCCESS;
+}
+
+int dll_getRecordingStats(int callId, RecordingStats* stats)
+{
+	call_rec *r;
+
+	if (callId < 0 || callId >= (int)PJ_ARRAY_SIZE(rec.calls) || stats == NULL)
+		return PJ_EINVAL;
+
+	if (rec.mutex == NULL)
+		return PJ_EINVALIDOP;
+
+	pj_mutex_lock(rec.mutex);
+	r = rec.calls[callId];
+	if (r == NULL) {
+		pj_mutex_unlock(rec.mutex);
+		return PJ_ENOTFOUND;
+	}
+
+	// counters are updated without locks, values may be one frame old
+	stats->bufferSize = REC_BUFFER_SIZE;
+	stats->bufferFill = (pj_uint32_t)pj_atomic_get(r->head) - (pj_uint32_t)pj_atomic_get(r->tail);
+	stats->maxBufferFill = r->max_fill;
+	stats->droppedFrames = r->dropped_frames;
+	stats->droppedBytes = r->dropped_bytes;
+	stats->bytesWritten = r->data_size;
+	stats->writes = r->writes;
+	pj_mutex_unlock(rec.mutex);
+
+	return PJ_SUCCESS;
+}
@@ -0,0 +1,64 @@
+/*
+ * Copyright (C) 2007 Sasa Coh <sasacoh@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+// pjsipDll_Recorder.h : Per call recording
+//
+
+#ifdef LINUX
+	#define __stdcall
+	#define PJSIPDLL_DLL_API
+#else
+#ifdef PJSIPDLL_EXPORTS
+	#define PJSIPDLL_DLL_API __declspec(dllexport)
+#else
+	#define PJSIPDLL_DLL_API __declspec(dllimport)
+#endif
+#endif
+
+// Recording formats, REC_FORMAT_STEREO may be combined with any encoding
+enum ERecordingFormat
+{
+	REC_FORMAT_PCM16 = 0,		// 16-bit linear WAV
+	REC_FORMAT_ULAW = 1,		// G.711 u-law WAV
+	REC_FORMAT_ALAW = 2,		// G.711 A-law WAV
+	REC_FORMAT_STEREO = 0x100	// left channel received from call, right channel sent to call
+};
+
+// Recording statistics, all sizes in bytes
+struct RecordingStats
+{
+	int bufferSize;
+	int bufferFill;
+	int maxBufferFill;
+	int droppedFrames;		// frames lost because disk fell behind
+	int droppedBytes;
+	int bytesWritten;
+	int writes;			// number of file writes
+};
+
+// Recording API
+extern "C" PJSIPDLL_DLL_API int dll_startRecording(int callId, char* path, int format);
+extern "C" PJSIPDLL_DLL_API int dll_stopRecording(int callId);
+extern "C" PJSIPDLL_DLL_API int dll_getRecordingStats(int callId, RecordingStats* stats);
+
+// Internal hooks called by pjsipDll.cpp
+int rec_init(void);
+void rec_destroy(void);
+int rec_create_file(const char *path, int *p_slot);
+void rec_on_call_media(int callId);
+void rec_on_call_disconnected(int callId);